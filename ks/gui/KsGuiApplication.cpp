@@ -15,7 +15,11 @@
 */
 
 #include <ks/gui/KsGuiApplication.hpp>
-#include <ks/gui/KsGuiPlatform.hpp>
+#include <ks/gui/KsGuiPlatformDispatch.hpp>
+#include <ks/gui/KsGuiTrace.hpp>
+#include <ks/gui/KsGuiMetrics.hpp>
+#include <fstream>
+#include <cstdio>
 
 namespace ks
 {
@@ -48,26 +52,32 @@ namespace ks
             m_platform(SetupPlatform(GetEventLoop())),
 
             signal_keyboard_input(
-                &(m_platform->signal_keyboard_input)),
+                &m_signal_keyboard_input),
+
+            signal_text_input(
+                &m_signal_text_input),
 
             signal_utf8_input(
                 &(m_platform->signal_utf8_input)),
 
             signal_mouse_input(
-                &(m_platform->signal_mouse_input)),
+                &m_signal_mouse_input),
 
             signal_touch_input(
-                &(m_platform->signal_touch_input)),
+                &m_signal_touch_input),
 
             signal_scroll_input(
-                &(m_platform->signal_scroll_input)),
+                &m_signal_scroll_input),
 
             signal_processed_events(
-                &(m_platform->signal_processed_events)),
+                &m_signal_processed_events),
 
-            m_quitting(false)
+            m_quitting(false),
+            m_input_window_id(0),
+            m_event_waiter(make_shared<EventWaiter>()),
+            m_metrics_has_previous(false)
         {
-
+            m_platform->SetEventWaiter(m_event_waiter);
         }
 
         void Application::Init(ks::Object::Key const &,
@@ -101,6 +111,41 @@ namespace ks
                         &Application::onGraphicsReset,
                         ks::ConnectionType::Direct);
 
+            g_platform->signal_keyboard_input.Connect(
+                        this_app,
+                        &Application::onKeyboardInput,
+                        ks::ConnectionType::Direct);
+
+            g_platform->signal_text_input.Connect(
+                        this_app,
+                        &Application::onTextInput,
+                        ks::ConnectionType::Direct);
+
+            g_platform->signal_utf8_input.Connect(
+                        this_app,
+                        &Application::onUtf8Input,
+                        ks::ConnectionType::Direct);
+
+            g_platform->signal_mouse_input.Connect(
+                        this_app,
+                        &Application::onMouseInput,
+                        ks::ConnectionType::Direct);
+
+            g_platform->signal_touch_input.Connect(
+                        this_app,
+                        &Application::onTouchInput,
+                        ks::ConnectionType::Direct);
+
+            g_platform->signal_scroll_input.Connect(
+                        this_app,
+                        &Application::onScrollInput,
+                        ks::ConnectionType::Direct);
+
+            g_platform->signal_processed_events.Connect(
+                        this_app,
+                        &Application::onProcessedEvents,
+                        ks::ConnectionType::Direct);
+
             this_app->signal_last_window_closed.Connect(
                         this_app,
                         &Application::onLastWindowClosed);
@@ -111,7 +156,36 @@ namespace ks
 
         void Application::ProcessEvents()
         {
+            KS_GUI_TRACE_SCOPE("Application::ProcessEvents",0);
+
+            Metrics::AddProcessEvents();
             g_platform->ProcessEvents();
+
+            // In case the platform didn't emit processed_events
+            flushWindowNotifications();
+            flushPointerEvents();
+        }
+
+        bool Application::WaitEvents(Milliseconds timeout)
+        {
+            KS_GUI_TRACE_SCOPE("Application::WaitEvents",0);
+
+            bool const woken = g_platform->WaitEvents(*m_event_waiter,timeout);
+
+            ProcessEvents();
+
+            return woken;
+        }
+
+        void Application::WakeUp()
+        {
+            m_event_waiter->Wake();
+        }
+
+        void Application::PostTask(shared_ptr<Task> task)
+        {
+            this->GetEventLoop()->PostTask(std::move(task));
+            m_event_waiter->Wake();
         }
 
         void Application::Run()
@@ -134,6 +208,8 @@ namespace ks
                                   Window::Attributes win_attrs,
                                   Window::Properties win_props)
         {
+            KS_GUI_TRACE_SCOPE("Application::CreateWindow",0);
+
             shared_ptr<Application> this_app =
                     std::static_pointer_cast<Application>(
                         shared_from_this());
@@ -147,106 +223,67 @@ namespace ks
                     MakeObject<Window>(
                         window_evl,win_attrs,win_props);
 
+            // Lets the platform tag input events
+            platform_window->SetWindowId(window->GetId());
+
             m_list_windows.emplace_back(
                         PlatformWindowDesc{
                             window->GetId(),
+                            window,
                             platform_window,
-                            MakeObject<ks::ConnectionContext>(
-                                this_app->GetEventLoop())
+                            window->m_command_channel,
+                            Window::Position(win_props.x,win_props.y),
+                            InputTransform()
                         });
 
             PlatformWindowDesc& desc = m_list_windows.back();
 
-            // Setup connections
+            // There's no way to query which screen a window
+            // is on so the primary screen is assumed
+            auto list_screens = g_platform->GetScreens();
+            m_input_screen =
+                    list_screens.empty() ?
+                        nullptr : list_screens.front();
 
-            // PlatformWindow ---> Window
-            platform_window->signal_size_changed.Connect(
-                        &window->size,
-                        &DeferredProperty<gui::Window::Size>::Notify,
-                        window);
-
-            platform_window->signal_position_changed.Connect(
-                        &window->position,
-                        &DeferredProperty<Window::Position>::Notify,
-                        window);
-
-            platform_window->signal_fullscreen_changed.Connect(
-                        &window->fullscreen,
-                        &DeferredProperty<gui::Window::FullscreenMode>::Notify,
-                        window);
-
-            platform_window->signal_focused_changed.Connect(
-                        &window->focused,
-                        &DeferredProperty<bool>::Notify,
-                        window);
-
-            platform_window->signal_visible_changed.Connect(
-                        &window->visible,
-                        &DeferredProperty<bool>::Notify,
-                        window);
-
-            platform_window->signal_always_on_top_changed.Connect(
-                        &window->always_on_top,
-                        &DeferredProperty<bool>::Notify,
-                        window);
-
-            platform_window->signal_swap_interval_changed.Connect(
-                        &window->swap_interval,
-                        &DeferredProperty<uint>::Notify,
-                        window);
-
-            platform_window->signal_title_changed.Connect(
-                        &window->title,
-                        &DeferredProperty<std::string>::Notify,
-                        window);
-
-            platform_window->signal_close.Connect(
-                        window,
-                        &Window::Close);
-
-
-            // Window ---> PlatformWindow
-            window->size.signal_set.Connect(
-                        platform_window.get(),
-                        &IPlatformWindow::SetSize,
-                        desc.connection_context);
-
-            window->position.signal_set.Connect(
-                        platform_window.get(),
-                        &IPlatformWindow::SetPosition,
-                        desc.connection_context);
-
-            window->fullscreen.signal_set.Connect(
-                        platform_window.get(),
-                        &IPlatformWindow::SetFullscreen,
-                        desc.connection_context);
-
-            // Note the direct connections since we need
-            // to invoke these functions from the context
-            // of the render thread
-            window->signal_make_context_current.Connect(
-                        platform_window.get(),
-                        &IPlatformWindow::MakeContextCurrent,
-                        desc.connection_context,
-                        ks::ConnectionType::Direct);
+            updateInputTransform(desc);
 
-            window->signal_release_context.Connect(
-                        platform_window.get(),
-                        &IPlatformWindow::ReleaseContext,
-                        desc.connection_context,
-                        ks::ConnectionType::Direct);
+            if(m_input_window_id == 0) {
+                m_input_window_id = desc.id;
+            }
 
-            window->signal_swap_buffers.Connect(
-                        platform_window.get(),
-                        &IPlatformWindow::SwapBuffers,
-                        desc.connection_context,
-                        ks::ConnectionType::Direct);
+            // Setup connections
 
+            // PlatformWindow ---> Window, Application
+            // * Notifications are drained after the platform
+            //   processes events (see flushWindowNotifications)
+
+            // Window ---> PlatformWindow, Application
+            // * Commands are drained on the application's
+            //   EventLoop in batches
+            Id const win_id = desc.id;
+            weak_ptr<Application> weak_app = this_app;
+
+            window->m_command_channel->SetPendingCallback(
+                        [weak_app,win_id]() {
+                            auto app = weak_app.lock();
+                            if(!app) {
+                                return;
+                            }
+
+                            app->PostTask(
+                                    make_shared<Task>(
+                                        [weak_app,win_id]() {
+                                            if(auto app = weak_app.lock()) {
+                                                app->drainWindowCommands(win_id);
+                                            }
+                                        }));
+                        });
 
-            // Window ---> Application
-            window->signal_app_close_window.Connect(
-                        this_app,
-                        &Application::onCloseWindow);
+            // Window ---> PlatformWindow (render path)
+            // * Called directly from the render thread
+            PlatformWindowDispatch::Check(platform_window.get());
+            window->m_platform_window = platform_window.get();
+            window->m_has_gl_context = platform_window->GetHasGLContext();
 
 
             // Application ---> Window
@@ -275,20 +312,91 @@ namespace ks
 
 
             // Start rendering
-            window_evl->PostTask(
-                        make_shared<Task>(
-                            [window](){
-                                window->onWindowReady();
-                            }));
+            // * The first frame request makes the Window ready
+            window->postFrameTask();
 
             return window;
         }
 
+        InputPredictor& Application::GetInputPredictor()
+        {
+            return m_input_predictor;
+        }
+
+        shared_ptr<PresentGroup> Application::CreatePresentGroup(
+                std::vector<shared_ptr<Window>> const &list_windows)
+        {
+            if(list_windows.empty()) {
+                throw PresentGroupInvalid(
+                            "Application: PresentGroup has no windows");
+            }
+
+            for(auto const &window : list_windows) {
+                if(!window) {
+                    throw PresentGroupInvalid(
+                                "Application: PresentGroup window is null");
+                }
+            }
+
+            auto const event_loop = list_windows[0]->GetEventLoop();
+
+            for(auto const &window : list_windows) {
+                if(window->GetEventLoop() != event_loop) {
+                    throw PresentGroupInvalid(
+                                "Application: PresentGroup windows must "
+                                "share the same EventLoop");
+                }
+            }
+
+            return make_shared<PresentGroup>(list_windows);
+        }
+
+        InputState const & Application::GetInputState() const
+        {
+            return m_input_state;
+        }
+
+        void Application::SetContextConfigCache(shared_ptr<ContextConfigCache> cache)
+        {
+            g_platform->SetContextConfigCache(std::move(cache));
+        }
+
+        void Application::SetMetricsDump(std::string path,
+                                         Milliseconds interval)
+        {
+            if(m_metrics_timer) {
+                m_metrics_timer->Stop();
+                m_metrics_timer.reset();
+            }
+
+            m_metrics_path = std::move(path);
+            m_metrics_has_previous = false;
+
+            if(m_metrics_path.empty() || interval.count() <= 0) {
+                return;
+            }
+
+            m_metrics_timer =
+                    MakeObject<CallbackTimer>(
+                        this->GetEventLoop(),
+                        interval,
+                        [this](){
+                            this->dumpMetrics();
+                        });
+
+            m_metrics_timer->Start();
+        }
+
         void Application::Quit()
         {
             if(!m_quitting) {
                 LOG.Trace() << "Application::Quit";
                 m_quitting = true;
+
+                if(m_metrics_timer) {
+                    m_metrics_timer->Stop();
+                }
+
                 signal_quit.Emit();
                 g_platform->Quit();
             }
@@ -296,12 +404,20 @@ namespace ks
 
         void Application::onPause()
         {
+            KS_GUI_TRACE_SCOPE("Application::onPause",0);
+
             LOG.Trace() << "Application::onPause";
+
+            // Release events won't be received while paused
+            m_input_state.Clear();
+
             signal_pause.Emit();
         }
 
         void Application::onResume()
         {
+            KS_GUI_TRACE_SCOPE("Application::onResume",0);
+
             LOG.Trace() << "Application::onResume";
             signal_resume.Emit();
         }
@@ -314,12 +430,16 @@ namespace ks
 
         void Application::onGraphicsReset()
         {
+            KS_GUI_TRACE_SCOPE("Application::onGraphicsReset",0);
+
             LOG.Trace() << "Application::onGraphicsReset";
             signal_graphics_reset.Emit();
         }
 
         void Application::onCloseWindow(Id win_id)
         {
+            KS_GUI_TRACE_SCOPE("Application::onCloseWindow",win_id);
+
             auto it = std::find_if(
                         m_list_windows.begin(),
                         m_list_windows.end(),
@@ -333,6 +453,12 @@ namespace ks
                 m_list_windows.erase(it);
             }
 
+            if(m_input_window_id == win_id) {
+                m_input_window_id =
+                        m_list_windows.empty() ?
+                            0 : m_list_windows.back().id;
+            }
+
             LOG.Trace() << "Application::onCloseWindow";
             if(m_list_windows.empty()) {
                 LOG.Trace() << "onCloseWindow emit lastWindowClosed";
@@ -344,5 +470,347 @@ namespace ks
         {
             LOG.Trace() << "Application::onLastWindowClosed";
         }
+
+        void Application::onKeyboardInput(KeyEvent event)
+        {
+            // Earlier pointer events go first
+            flushPointerEvents();
+
+            event.window_id = resolveWindowId(event.window_id);
+            KS_GUI_TRACE_SCOPE("Application::dispatchKeyboardInput",event.window_id);
+
+            Metrics::AddEvents(Metrics::EventType::Keyboard);
+            m_input_state.ProcessKeyEvent(event);
+            m_signal_keyboard_input.Emit(event);
+
+            if(auto window = lockWindow(event.window_id)) {
+                window->queueAppInput();
+                window->signal_app_keyboard_input.Emit(event);
+            }
+        }
+
+        void Application::onTextInput(TextInputEvent event)
+        {
+            flushPointerEvents();
+
+            event.window_id = resolveWindowId(event.window_id);
+            KS_GUI_TRACE_SCOPE("Application::dispatchTextInput",event.window_id);
+
+            Metrics::AddEvents(Metrics::EventType::Text);
+            m_signal_text_input.Emit(event);
+
+            if(auto window = lockWindow(event.window_id)) {
+                window->queueAppInput();
+                window->signal_app_text_input.Emit(event);
+            }
+        }
+
+        void Application::onUtf8Input(std::string text)
+        {
+            onTextInput(
+                        TextInputEvent(
+                            text.data(),
+                            text.size(),
+                            std::chrono::steady_clock::now()));
+        }
+
+        void Application::onMouseInput(MouseEvent event)
+        {
+            m_input_state.ProcessMouseEvent(event);
+
+            m_list_pending_pointer.emplace_back();
+            m_list_pending_pointer.back().is_touch = false;
+            m_list_pending_pointer.back().mouse = event;
+        }
+
+        void Application::onTouchInput(TouchEvent event)
+        {
+            m_list_pending_pointer.emplace_back();
+            m_list_pending_pointer.back().is_touch = true;
+            m_list_pending_pointer.back().touch = event;
+        }
+
+        void Application::onScrollInput(ScrollEvent event)
+        {
+            flushPointerEvents();
+
+            event.window_id = resolveWindowId(event.window_id);
+            KS_GUI_TRACE_SCOPE("Application::dispatchScrollInput",event.window_id);
+
+            Metrics::AddEvents(Metrics::EventType::Scroll);
+            m_signal_scroll_input.Emit(event);
+
+            if(auto window = lockWindow(event.window_id)) {
+                window->queueAppInput();
+                window->signal_app_scroll_input.Emit(event);
+            }
+        }
+
+        void Application::onProcessedEvents(bool events_processed)
+        {
+            flushWindowNotifications();
+            flushPointerEvents();
+            m_signal_processed_events.Emit(events_processed);
+        }
+
+        void Application::onWindowPositionChanged(Id win_id,
+                                                  Window::Position position)
+        {
+            for(auto& desc : m_list_windows) {
+                if(desc.id == win_id) {
+                    desc.position = position;
+                    updateInputTransform(desc);
+                    break;
+                }
+            }
+        }
+
+        void Application::onWindowFocusChanged(Id win_id,bool focused)
+        {
+            if(focused) {
+                m_input_window_id = win_id;
+            }
+            else if(win_id == m_input_window_id) {
+                // Release events won't be received once
+                // the window has lost focus
+                m_input_state.Clear();
+            }
+        }
+
+        void Application::drainWindowCommands(Id win_id)
+        {
+            auto it = std::find_if(
+                        m_list_windows.begin(),
+                        m_list_windows.end(),
+                        [win_id](PlatformWindowDesc const &window_desc) {
+                            return (window_desc.id == win_id);
+                        });
+
+            if(it == m_list_windows.end()) {
+                return;
+            }
+
+            bool const close = it->command_channel->Drain(m_window_properties);
+
+            if(m_window_properties.flags != 0) {
+                it->platform_window->ApplyProperties(m_window_properties);
+            }
+
+            if(close) {
+                onCloseWindow(win_id);
+            }
+        }
+
+        void Application::flushWindowNotifications()
+        {
+            for(std::size_t i=0; i < m_list_windows.size(); i++)
+            {
+                PlatformWindowDesc& desc = m_list_windows[i];
+                desc.platform_window->DrainNotifications(m_list_notifications);
+
+                if(m_list_notifications.empty()) {
+                    continue;
+                }
+
+                Id const win_id = desc.id;
+                shared_ptr<Window> window = desc.window.lock();
+
+                // Size and position go through the Window on this
+                // thread so they can be coalesced; the whole batch
+                // is then queued to the Window so it can notify
+                // the rest and emit signal_properties_changed
+                for(auto& notification : m_list_notifications)
+                {
+                    using Type = WindowNotification::Type;
+
+                    if(notification.type == Type::SizeChanged) {
+                        if(window) {
+                            window->onPlatformSizeChanged(notification.size);
+                        }
+                    }
+                    else if(notification.type == Type::PositionChanged) {
+                        onWindowPositionChanged(win_id,notification.position);
+                        if(window) {
+                            window->onPlatformPositionChanged(notification.position);
+                        }
+                    }
+                    else if(notification.type == Type::FocusedChanged) {
+                        onWindowFocusChanged(win_id,notification.flag);
+                    }
+
+                    if(window) {
+                        window->m_notify_inbox->channel.Push(std::move(notification));
+                    }
+                }
+
+                m_list_notifications.clear();
+            }
+        }
+
+        void Application::flushPointerEvents()
+        {
+            if(m_list_pending_pointer.empty()) {
+                return;
+            }
+
+            KS_GUI_TRACE_SCOPE("Application::flushPointerEvents",0);
+
+            std::size_t const count = m_list_pending_pointer.size();
+            u64 mouse_count = 0;
+
+            // Tag events from platforms that don't know
+            // the source window
+            for(auto& pending : m_list_pending_pointer) {
+                pending.WindowId() = resolveWindowId(pending.WindowId());
+                mouse_count += (pending.is_touch ? 0 : 1);
+            }
+
+            // Gather the coordinates of each window's pending
+            // pointer events so they can be transformed in one pass
+            for(auto& desc : m_list_windows)
+            {
+                m_list_batch_x.clear();
+                m_list_batch_y.clear();
+
+                for(auto& pending : m_list_pending_pointer) {
+                    if(pending.WindowId() == desc.id) {
+                        m_list_batch_x.push_back(pending.X());
+                        m_list_batch_y.push_back(pending.Y());
+                    }
+                }
+
+                if(m_list_batch_x.empty()) {
+                    continue;
+                }
+
+                desc.input_transform.Apply(
+                            m_list_batch_x.data(),
+                            m_list_batch_y.data(),
+                            m_list_batch_x.size());
+
+                std::size_t k=0;
+                for(auto& pending : m_list_pending_pointer) {
+                    if(pending.WindowId() == desc.id) {
+                        pending.X() = m_list_batch_x[k];
+                        pending.Y() = m_list_batch_y[k];
+                        k++;
+                    }
+                }
+            }
+
+            // Update the motion history before any slots
+            // see the events so predictions include them
+            for(std::size_t i=0; i < count; i++) {
+                PendingPointerEvent const &pending = m_list_pending_pointer[i];
+                if(pending.is_touch) {
+                    m_input_predictor.ProcessTouchEvent(pending.touch);
+                }
+                else {
+                    m_input_predictor.ProcessMouseEvent(pending.mouse);
+                }
+            }
+
+            Metrics::AddEvents(Metrics::EventType::Mouse,mouse_count);
+            Metrics::AddEvents(Metrics::EventType::Touch,count-mouse_count);
+
+            // Deliver in the order the events were received
+            for(std::size_t i=0; i < count; i++)
+            {
+                if(m_list_pending_pointer[i].is_touch)
+                {
+                    TouchEvent const event = m_list_pending_pointer[i].touch;
+                    KS_GUI_TRACE_SCOPE("Application::dispatchTouchInput",event.window_id);
+
+                    m_signal_touch_input.Emit(event);
+
+                    if(auto window = lockWindow(event.window_id)) {
+                        window->queueAppInput();
+                        window->signal_app_touch_input.Emit(event);
+                    }
+                }
+                else
+                {
+                    MouseEvent const event = m_list_pending_pointer[i].mouse;
+                    KS_GUI_TRACE_SCOPE("Application::dispatchMouseInput",event.window_id);
+
+                    m_signal_mouse_input.Emit(event);
+
+                    if(auto window = lockWindow(event.window_id)) {
+                        window->queueAppInput();
+                        window->signal_app_mouse_input.Emit(event);
+                    }
+                }
+            }
+
+            // Keep the capacity so steady state input
+            // doesn't allocate
+            m_list_pending_pointer.erase(
+                        m_list_pending_pointer.begin(),
+                        m_list_pending_pointer.begin()+count);
+        }
+
+        void Application::dumpMetrics()
+        {
+            Metrics::Snapshot snapshot = Metrics::GetSnapshot();
+
+            // Write to a temporary file and rename it so
+            // collectors never read a partial dump. The name
+            // is unique so processes dumping to the same path
+            // don't write into the same file.
+            std::string const tmp_path = ContextConfigCache::GetTempPath(m_metrics_path);
+            {
+                std::ofstream file(tmp_path,std::ios::out|std::ios::trunc);
+                if(!file) {
+                    LOG.Warn() << "Application: failed to open "
+                               << tmp_path << " for metrics";
+                    return;
+                }
+
+                Metrics::WriteText(
+                            file,
+                            snapshot,
+                            m_metrics_has_previous ? &m_metrics_previous : nullptr);
+            }
+
+            if(std::rename(tmp_path.c_str(),m_metrics_path.c_str()) != 0) {
+                LOG.Warn() << "Application: failed to write metrics to "
+                           << m_metrics_path;
+                std::remove(tmp_path.c_str());
+            }
+
+            m_metrics_previous = std::move(snapshot);
+            m_metrics_has_previous = true;
+        }
+
+        void Application::updateInputTransform(PlatformWindowDesc& desc)
+        {
+            if(!m_input_screen) {
+                desc.input_transform = InputTransform();
+                return;
+            }
+
+            desc.input_transform =
+                    InputTransform::Create(
+                        *m_input_screen,
+                        desc.position);
+        }
+
+        Id Application::resolveWindowId(Id win_id) const
+        {
+            if(win_id == 0) {
+                return m_input_window_id;
+            }
+            return win_id;
+        }
+
+        shared_ptr<Window> Application::lockWindow(Id win_id) const
+        {
+            for(auto const &desc : m_list_windows) {
+                if(desc.id == win_id) {
+                    return desc.window.lock();
+                }
+            }
+            return nullptr;
+        }
     }
 }
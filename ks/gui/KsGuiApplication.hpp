@@ -21,7 +21,15 @@
 #include <ks/KsSignal.hpp>
 #include <ks/gui/KsGuiScreen.hpp>
 #include <ks/gui/KsGuiWindow.hpp>
+#include <ks/gui/KsGuiWindowChannel.hpp>
 #include <ks/gui/KsGuiInput.hpp>
+#include <ks/gui/KsGuiInputTransform.hpp>
+#include <ks/gui/KsGuiInputPredictor.hpp>
+#include <ks/gui/KsGuiInputState.hpp>
+#include <ks/gui/KsGuiEventWaiter.hpp>
+#include <ks/gui/KsGuiMetrics.hpp>
+#include <ks/gui/KsGuiPresentGroup.hpp>
+#include <ks/gui/KsGuiContextConfigCache.hpp>
 
 namespace ks
 {
@@ -52,6 +60,30 @@ namespace ks
             // * This needs to be invoked manually
             void ProcessEvents();
 
+            // * Blocks until platform events are waiting, WakeUp
+            //   is called or @timeout expires and then processes
+            //   any waiting events. A negative @timeout doesn't
+            //   expire.
+            // * Use this instead of calling ProcessEvents in a
+            //   loop so the main thread sleeps while idle
+            // * Returns false if the wait timed out without
+            //   anything waking the application. Platforms
+            //   without an event fd time out at each polling
+            //   interval (see IPlatform::WaitEvents).
+            bool WaitEvents(Milliseconds timeout);
+
+            // * Wakes a call to WaitEvents, or makes the next
+            //   call return immediately
+            // * Thread safe
+            void WakeUp();
+
+            // * Posts @task to the application's EventLoop and
+            //   wakes WaitEvents so that it's run promptly
+            // * Thread safe. Tasks posted to the EventLoop
+            //   directly won't wake WaitEvents on their own;
+            //   call WakeUp afterwards
+            void PostTask(shared_ptr<Task> task);
+
             // * Starts the application event loop, blocking the
             //   calling thread
             void Run();
@@ -77,6 +109,44 @@ namespace ks
                                             Window::Attributes win_attrs,
                                             Window::Properties win_props);
 
+            // * Returns the predictor that tracks the mouse and
+            //   touch input emitted by this Application
+            // * The predictor is thread safe so it can be queried
+            //   from render threads (ie. with the presentation
+            //   time of the next frame)
+            InputPredictor& GetInputPredictor();
+
+            // * Creates a group that renders and presents
+            //   @list_windows together so that they only wait
+            //   for one vsync per frame (see PresentGroup)
+            // * All windows must share the same EventLoop;
+            //   throws PresentGroupInvalid otherwise
+            // * Members that are presented by the group have
+            //   their context swap interval changed; if a window
+            //   is later presented on its own, set it again with
+            //   RenderContext::SetSwapInterval
+            shared_ptr<PresentGroup> CreatePresentGroup(
+                    std::vector<shared_ptr<Window>> const &list_windows);
+
+            // * Returns the current key, mouse button and
+            //   modifier state
+            // * Thread safe; the state can be read from any
+            //   thread without blocking
+            InputState const & GetInputState() const;
+
+            // * Periodically writes a Metrics snapshot to the
+            //   file at @path, replacing its contents each time
+            // * Pass an empty @path or a zero @interval to stop
+            //   dumping. Use Metrics::GetSnapshot to pull the
+            //   values instead.
+            void SetMetricsDump(std::string path, Milliseconds interval);
+
+            // * Lets the platform reuse the context configs it
+            //   negotiated on previous launches; call before
+            //   creating windows
+            // * Pass nullptr to disable caching
+            void SetContextConfigCache(shared_ptr<ContextConfigCache> cache);
+
             // * Tells the application to start quitting
             // * Returns immediately. Calling quit will eventually
             //   stop the main EventLoop and cause Run() to return
@@ -107,7 +177,21 @@ namespace ks
             Signal<> signal_last_window_closed;
 
             // Input
+            // * Events for all windows; prefer the input signals
+            //   on Window to only receive events for that window
+            // * Events are tagged with the Id of their Window
+            // * Mouse and touch coordinates are in logical window
+            //   units (see InputTransform). Pointer events are
+            //   transformed in batches and emitted once the
+            //   platform has finished processing events
             Signal<KeyEvent>* const signal_keyboard_input;
+            Signal<TextInputEvent>* const signal_text_input;
+
+            // * Deprecated: use signal_text_input which doesn't
+            //   allocate for each event
+            // * Only emitted by platforms that haven't moved
+            //   to text input events; their text is also
+            //   emitted on signal_text_input
             Signal<std::string>* const signal_utf8_input;
             Signal<MouseEvent>* const signal_mouse_input;
             Signal<TouchEvent>* const signal_touch_input;
@@ -128,6 +212,21 @@ namespace ks
             void onCloseWindow(Id win_id);
             void onLastWindowClosed();
 
+            void onKeyboardInput(KeyEvent event);
+            void onTextInput(TextInputEvent event);
+            void onUtf8Input(std::string text);
+            void onMouseInput(MouseEvent event);
+            void onTouchInput(TouchEvent event);
+            void onScrollInput(ScrollEvent event);
+            void onProcessedEvents(bool events_processed);
+            void onWindowPositionChanged(Id win_id,Window::Position position);
+            void onWindowFocusChanged(Id win_id,bool focused);
+
+            void drainWindowCommands(Id win_id);
+            void flushWindowNotifications();
+            void flushPointerEvents();
+            void dumpMetrics();
+
             bool m_quitting;
 
             // * We don't hang on to ks::gui::Window shared_ptrs so
@@ -136,11 +235,65 @@ namespace ks
             struct PlatformWindowDesc
             {
                 Id id;
+                weak_ptr<Window> window;
                 shared_ptr<IPlatformWindow> platform_window;
-                shared_ptr<ks::ConnectionContext> connection_context;
+                shared_ptr<WindowCommandChannel> command_channel;
+                Window::Position position;
+                InputTransform input_transform;
             };
 
+            void updateInputTransform(PlatformWindowDesc& desc);
+            Id resolveWindowId(Id win_id) const;
+            shared_ptr<Window> lockWindow(Id win_id) const;
+
             std::vector<PlatformWindowDesc> m_list_windows;
+            Window::PropertyChanges m_window_properties;
+            std::vector<WindowNotification> m_list_notifications;
+
+            shared_ptr<Screen const> m_input_screen;
+
+            // * The window that receives input events not
+            //   tagged by the platform (the last focused window)
+            Id m_input_window_id;
+
+            // * Pointer events are buffered while the platform
+            //   processes events so they can be transformed
+            //   as a batch
+            // * Mouse and touch events share one queue so they're
+            //   delivered in the order they were received. The
+            //   queue is flushed before any other input is
+            //   dispatched for the same reason.
+            struct PendingPointerEvent
+            {
+                bool is_touch;
+                MouseEvent mouse;
+                TouchEvent touch;
+
+                float& X() { return (is_touch ? touch.x : mouse.x); }
+                float& Y() { return (is_touch ? touch.y : mouse.y); }
+                Id& WindowId() { return (is_touch ? touch.window_id : mouse.window_id); }
+            };
+
+            std::vector<PendingPointerEvent> m_list_pending_pointer;
+            std::vector<float> m_list_batch_x;
+            std::vector<float> m_list_batch_y;
+
+            InputPredictor m_input_predictor;
+            InputState m_input_state;
+
+            shared_ptr<EventWaiter> const m_event_waiter;
+
+            std::string m_metrics_path;
+            shared_ptr<CallbackTimer> m_metrics_timer;
+            bool m_metrics_has_previous;
+            Metrics::Snapshot m_metrics_previous;
+
+            Signal<KeyEvent> m_signal_keyboard_input;
+            Signal<TextInputEvent> m_signal_text_input;
+            Signal<MouseEvent> m_signal_mouse_input;
+            Signal<TouchEvent> m_signal_touch_input;
+            Signal<ScrollEvent> m_signal_scroll_input;
+            Signal<bool> m_signal_processed_events;
 		};
 			
 	} // gui
@@ -24,5 +24,34 @@
     #define KS_ENV_SINGLE_WINDOW 1
 #endif
 
+// * Builds that only ship one platform backend can bind the
+//   render path (make current, swap, release) directly to its
+//   window class instead of calling through IPlatformWindow:
+//   define KS_GUI_PLATFORM_WINDOW_TYPE as the fully qualified
+//   class and KS_GUI_PLATFORM_WINDOW_HEADER as its header, ie.
+//   -DKS_GUI_PLATFORM_WINDOW_TYPE=ks::gui::SDLPlatformWindow
+//   -DKS_GUI_PLATFORM_WINDOW_HEADER=\"KsGuiSDLPlatformWindow.hpp\"
+// * Every platform window created must then be of that type;
+//   leave both undefined to keep runtime dispatch (ie. for
+//   tests that provide their own IPlatform)
+#if defined(KS_GUI_PLATFORM_WINDOW_TYPE) && !defined(KS_GUI_PLATFORM_WINDOW_HEADER)
+    #error "KS_GUI_PLATFORM_WINDOW_HEADER must be defined with KS_GUI_PLATFORM_WINDOW_TYPE"
+#endif
+
+// * Define KS_GUI_PLATFORM_SHM to build the headless shared
+//   memory platform (KsGuiShmPlatform.hpp, Linux only) as the
+//   platform returned by CreatePlatform, instead of linking a
+//   separate platform backend
+// * Define KS_GUI_PLATFORM_REMOTE instead to stream frames to
+//   a client over a Unix socket (KsGuiRemotePlatform.hpp); the
+//   socket path is read from the KS_GUI_REMOTE_SOCKET
+//   environment variable
+#if (defined(KS_GUI_PLATFORM_SHM) || defined(KS_GUI_PLATFORM_REMOTE)) && !defined(__linux__)
+    #error "KS_GUI_PLATFORM_SHM and KS_GUI_PLATFORM_REMOTE require Linux (memfd)"
+#endif
+
+#if defined(KS_GUI_PLATFORM_SHM) && defined(KS_GUI_PLATFORM_REMOTE)
+    #error "Only one of KS_GUI_PLATFORM_SHM and KS_GUI_PLATFORM_REMOTE can be defined"
+#endif
 
 #endif // KS_GUI_CONFIG_HPP
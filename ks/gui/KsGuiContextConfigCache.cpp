@@ -0,0 +1,363 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <ks/gui/KsGuiContextConfigCache.hpp>
+#include <ks/gl/KsGLConfig.hpp>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <iterator>
+#include <thread>
+
+#ifdef _WIN32
+    #include <process.h>
+#else
+    #include <unistd.h>
+#endif
+
+namespace ks
+{
+    namespace gui
+    {
+        namespace {
+            char const * const g_file_magic = "ks_gui_context_config_cache";
+
+            // * Only the attributes that select a surface
+            //   and context are part of the key
+            bool AttributesMatch(Window::Attributes const &a,
+                                 Window::Attributes const &b)
+            {
+                return (a.red_bits == b.red_bits &&
+                        a.green_bits == b.green_bits &&
+                        a.blue_bits == b.blue_bits &&
+                        a.alpha_bits == b.alpha_bits &&
+                        a.depth_bits == b.depth_bits &&
+                        a.stencil_bits == b.stencil_bits &&
+                        a.samples == b.samples &&
+                        a.api == b.api &&
+                        a.profile == b.profile &&
+                        a.version_major == b.version_major &&
+                        a.version_minor == b.version_minor &&
+                        a.forward_compat == b.forward_compat);
+            }
+
+            void WriteAttributes(std::ostream &stream,
+                                 Window::Attributes const &attrs)
+            {
+                stream << attrs.red_bits << " "
+                       << attrs.green_bits << " "
+                       << attrs.blue_bits << " "
+                       << attrs.alpha_bits << " "
+                       << attrs.depth_bits << " "
+                       << attrs.stencil_bits << " "
+                       << attrs.samples << " "
+                       << static_cast<uint>(attrs.api) << " "
+                       << static_cast<uint>(attrs.profile) << " "
+                       << attrs.version_major << " "
+                       << attrs.version_minor << " "
+                       << (attrs.forward_compat ? 1 : 0);
+            }
+
+            bool ReadAttributes(std::istream &stream,
+                                Window::Attributes &attrs)
+            {
+                uint api;
+                uint profile;
+                uint forward_compat;
+
+                stream >> attrs.red_bits
+                       >> attrs.green_bits
+                       >> attrs.blue_bits
+                       >> attrs.alpha_bits
+                       >> attrs.depth_bits
+                       >> attrs.stencil_bits
+                       >> attrs.samples
+                       >> api
+                       >> profile
+                       >> attrs.version_major
+                       >> attrs.version_minor
+                       >> forward_compat;
+
+                if(!stream ||
+                   api > static_cast<uint>(Window::Attributes::OpenGLAPI::OpenGLES) ||
+                   profile > static_cast<uint>(Window::Attributes::OpenGLProfile::Auto))
+                {
+                    return false;
+                }
+
+                attrs.api = static_cast<Window::Attributes::OpenGLAPI>(api);
+                attrs.profile = static_cast<Window::Attributes::OpenGLProfile>(profile);
+                attrs.forward_compat = (forward_compat != 0);
+
+                return true;
+            }
+
+            // * Identities are stored one per line
+            std::string SanitizeIdentity(std::string identity)
+            {
+                for(auto& c : identity) {
+                    if(c == '\n' || c == '\r') {
+                        c = ' ';
+                    }
+                }
+                return identity;
+            }
+
+            char const * GetGLString(GLenum name)
+            {
+                char const * str =
+                        reinterpret_cast<char const *>(glGetString(name));
+
+                return (str ? str : "");
+            }
+        }
+
+        // ============================================================= //
+
+        ContextConfigCache::ContextConfigCache(std::string path) :
+            m_path(std::move(path)),
+            m_stats{0,0,0}
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            load();
+        }
+
+        bool ContextConfigCache::Lookup(std::string const &platform_identity,
+                                        Window::Attributes const &requested,
+                                        Config &config)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            auto it = find(SanitizeIdentity(platform_identity),requested);
+            if(it == m_list_entries.end()) {
+                m_stats.misses++;
+                return false;
+            }
+
+            m_stats.hits++;
+            config = it->config;
+
+            // Keep the window attributes that aren't cached
+            config.attributes.resizable = requested.resizable;
+            config.attributes.decorated = requested.decorated;
+
+            return true;
+        }
+
+        void ContextConfigCache::Store(std::string const &platform_identity,
+                                       Window::Attributes const &requested,
+                                       std::string const &driver_identity,
+                                       Config const &config)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            std::string const identity = SanitizeIdentity(platform_identity);
+
+            auto it = find(identity,requested);
+            if(it == m_list_entries.end()) {
+                m_list_entries.emplace_back();
+                it = std::prev(m_list_entries.end());
+            }
+
+            it->platform_identity = identity;
+            it->driver_identity = SanitizeIdentity(driver_identity);
+            it->requested = requested;
+            it->config = config;
+
+            save();
+        }
+
+        bool ContextConfigCache::Validate(std::string const &platform_identity,
+                                          Window::Attributes const &requested,
+                                          std::string const &driver_identity)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            auto it = find(SanitizeIdentity(platform_identity),requested);
+            if(it == m_list_entries.end()) {
+                return false;
+            }
+
+            if(it->driver_identity == SanitizeIdentity(driver_identity)) {
+                return true;
+            }
+
+            LOG.Trace() << "ContextConfigCache: Driver changed, "
+                           "dropping cached config";
+
+            m_list_entries.erase(it);
+            m_stats.invalidations++;
+            save();
+
+            return false;
+        }
+
+        void ContextConfigCache::Clear()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_list_entries.clear();
+            std::remove(m_path.c_str());
+        }
+
+        ContextConfigCache::Stats ContextConfigCache::GetStats() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_stats;
+        }
+
+        std::string ContextConfigCache::GetDriverIdentity()
+        {
+            std::string identity = GetGLString(GL_VENDOR);
+            identity += " | ";
+            identity += GetGLString(GL_RENDERER);
+            identity += " | ";
+            identity += GetGLString(GL_VERSION);
+
+            return identity;
+        }
+
+        std::string ContextConfigCache::GetTempPath(std::string const &path)
+        {
+        #ifdef _WIN32
+            auto const pid = _getpid();
+        #else
+            auto const pid = getpid();
+        #endif
+
+            std::ostringstream ss;
+            ss << path << ".tmp." << pid << "."
+               << std::hash<std::thread::id>()(std::this_thread::get_id());
+
+            return ss.str();
+        }
+
+        std::vector<ContextConfigCache::Entry>::iterator
+        ContextConfigCache::find(std::string const &platform_identity,
+                                 Window::Attributes const &requested)
+        {
+            auto it = m_list_entries.begin();
+            for(; it != m_list_entries.end(); ++it) {
+                if(it->platform_identity == platform_identity &&
+                   AttributesMatch(it->requested,requested))
+                {
+                    break;
+                }
+            }
+
+            return it;
+        }
+
+        void ContextConfigCache::load()
+        {
+            std::ifstream file(m_path);
+            if(!file) {
+                return;
+            }
+
+            // File format:
+            // ks_gui_context_config_cache <version>
+            // Per entry, four lines:
+            //   platform identity
+            //   driver identity
+            //   requested attributes
+            //   config attributes and platform config id
+            std::string magic;
+            u32 version = 0;
+            file >> magic >> version;
+
+            if(magic != g_file_magic || version != FileVersion) {
+                LOG.Trace() << "ContextConfigCache: Ignoring outdated "
+                            << m_path;
+                return;
+            }
+
+            std::string line;
+            std::getline(file,line);
+
+            std::vector<Entry> list_entries;
+
+            while(true)
+            {
+                Entry entry;
+                if(!std::getline(file,entry.platform_identity) ||
+                   !std::getline(file,entry.driver_identity))
+                {
+                    break;
+                }
+
+                if(!std::getline(file,line)) {
+                    break;
+                }
+
+                std::istringstream requested_stream(line);
+                if(!ReadAttributes(requested_stream,entry.requested)) {
+                    break;
+                }
+
+                if(!std::getline(file,line)) {
+                    break;
+                }
+
+                std::istringstream config_stream(line);
+                if(!ReadAttributes(config_stream,entry.config.attributes) ||
+                   !(config_stream >> entry.config.platform_config_id))
+                {
+                    break;
+                }
+
+                list_entries.push_back(std::move(entry));
+            }
+
+            m_list_entries = std::move(list_entries);
+        }
+
+        void ContextConfigCache::save()
+        {
+            // Write to a temporary file and rename it so another
+            // process starting up never reads a partial file. The
+            // name is unique so concurrent writers don't clobber
+            // each other's temporary file.
+            std::string const tmp_path = GetTempPath(m_path);
+            {
+                std::ofstream file(tmp_path,std::ios::out|std::ios::trunc);
+                if(!file) {
+                    LOG.Warn() << "ContextConfigCache: failed to open "
+                               << tmp_path;
+                    return;
+                }
+
+                file << g_file_magic << " " << FileVersion << "\n";
+
+                for(auto const &entry : m_list_entries) {
+                    file << entry.platform_identity << "\n"
+                         << entry.driver_identity << "\n";
+                    WriteAttributes(file,entry.requested);
+                    file << "\n";
+                    WriteAttributes(file,entry.config.attributes);
+                    file << " " << entry.config.platform_config_id << "\n";
+                }
+            }
+
+            if(std::rename(tmp_path.c_str(),m_path.c_str()) != 0) {
+                LOG.Warn() << "ContextConfigCache: failed to write "
+                           << m_path;
+                std::remove(tmp_path.c_str());
+            }
+        }
+
+        // ============================================================= //
+    }
+}
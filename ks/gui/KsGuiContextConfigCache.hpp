@@ -0,0 +1,136 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_CONTEXT_CONFIG_CACHE_HPP
+#define KS_GUI_CONTEXT_CONFIG_CACHE_HPP
+
+#include <mutex>
+#include <vector>
+#include <ks/gui/KsGuiWindow.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        // ============================================================= //
+
+        // * Remembers the surface and context configuration
+        //   a platform negotiated for requested Window
+        //   Attributes, so later launches can create the
+        //   context directly instead of searching configs
+        //   and fallbacks again
+        // * Entries are keyed by a platform identity (ie. the
+        //   display server or EGL vendor, anything known before
+        //   a context exists) and the requested surface and
+        //   context attributes. Each entry also records the
+        //   driver that created the context (see
+        //   GetDriverIdentity); platforms call Validate once
+        //   the context exists, which drops the entry if the
+        //   driver changed.
+        // * Platforms get the cache with IPlatform::
+        //   GetContextConfigCache. Thread safe.
+        class ContextConfigCache final
+        {
+        public:
+            static u32 const FileVersion = 1;
+
+            struct Config final
+            {
+                // * The negotiated surface and context attributes
+                Window::Attributes attributes;
+
+                // * A platform specific id for the chosen config
+                //   (ie. a GLX FBConfig or EGLConfig id), 0 if
+                //   the platform doesn't use one
+                u64 platform_config_id;
+            };
+
+            struct Stats final
+            {
+                u64 hits;
+                u64 misses;
+                u64 invalidations;
+            };
+
+            // * Loads the cache from @path if it exists; an
+            //   unreadable or outdated file is ignored
+            ContextConfigCache(std::string path);
+
+            // * Returns true and sets @config if a config was
+            //   stored for @requested under @platform_identity
+            bool Lookup(std::string const &platform_identity,
+                        Window::Attributes const &requested,
+                        Config &config);
+
+            // * Stores the config negotiated for @requested
+            //   and the identity of the driver that created
+            //   it, and writes the cache file
+            void Store(std::string const &platform_identity,
+                       Window::Attributes const &requested,
+                       std::string const &driver_identity,
+                       Config const &config);
+
+            // * Returns false and removes the entry for
+            //   @requested if it was stored with a different
+            //   @driver_identity (the driver was updated or the
+            //   GPU changed); the platform should negotiate
+            //   again and Store the new config
+            bool Validate(std::string const &platform_identity,
+                          Window::Attributes const &requested,
+                          std::string const &driver_identity);
+
+            // * Removes all entries and the cache file
+            void Clear();
+
+            Stats GetStats() const;
+
+            // * The GL vendor, renderer and version strings;
+            //   must be called with a context current
+            static std::string GetDriverIdentity();
+
+            // * A temporary file name next to @path that's unique
+            //   to the calling process and thread, for writing
+            //   @path and renaming the result over it
+            static std::string GetTempPath(std::string const &path);
+
+        private:
+            struct Entry
+            {
+                std::string platform_identity;
+                std::string driver_identity;
+                Window::Attributes requested;
+                Config config;
+            };
+
+            std::vector<Entry>::iterator find(
+                    std::string const &platform_identity,
+                    Window::Attributes const &requested);
+
+            void load();
+            void save();
+
+            std::string const m_path;
+
+            mutable std::mutex m_mutex;
+            std::vector<Entry> m_list_entries;
+            Stats m_stats;
+        };
+
+        // ============================================================= //
+    }
+}
+
+#endif // KS_GUI_CONTEXT_CONFIG_CACHE_HPP
@@ -0,0 +1,172 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <ks/gui/KsGuiEventWaiter.hpp>
+
+#ifdef KS_GUI_EVENT_WAITER_POLL
+    #include <poll.h>
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <cerrno>
+    #include <limits>
+
+    #if defined(__linux__)
+        #include <sys/eventfd.h>
+    #endif
+#endif
+
+namespace ks
+{
+    namespace gui
+    {
+        // ============================================================= //
+
+        EventWaiterInitFailed::EventWaiterInitFailed(std::string msg) :
+            ks::Exception(ks::Exception::ErrorLevel::FATAL,std::move(msg),true)
+        {}
+
+        // ============================================================= //
+
+    #ifdef KS_GUI_EVENT_WAITER_POLL
+
+        EventWaiter::EventWaiter()
+        {
+        #if defined(__linux__)
+            m_read_fd = eventfd(0,EFD_NONBLOCK|EFD_CLOEXEC);
+            if(m_read_fd < 0) {
+                throw EventWaiterInitFailed(
+                            "EventWaiter: Failed to create eventfd");
+            }
+            m_write_fd = m_read_fd;
+        #else
+            int list_fds[2];
+            if(pipe(list_fds) != 0) {
+                throw EventWaiterInitFailed(
+                            "EventWaiter: Failed to create pipe");
+            }
+
+            for(int fd : list_fds) {
+                fcntl(fd,F_SETFL,fcntl(fd,F_GETFL) | O_NONBLOCK);
+                fcntl(fd,F_SETFD,FD_CLOEXEC);
+            }
+
+            m_read_fd = list_fds[0];
+            m_write_fd = list_fds[1];
+        #endif
+        }
+
+        EventWaiter::~EventWaiter()
+        {
+            close(m_read_fd);
+            if(m_write_fd != m_read_fd) {
+                close(m_write_fd);
+            }
+        }
+
+        void EventWaiter::Wake()
+        {
+            // An eventfd takes an 8 byte counter increment;
+            // any data will do for a pipe. If the write fails
+            // because the fd is full a wake is already pending.
+            u64 const one = 1;
+            ssize_t result;
+            do {
+                result = write(m_write_fd,&one,sizeof(one));
+            }
+            while(result < 0 && errno == EINTR);
+        }
+
+        bool EventWaiter::Wait(Milliseconds timeout, int fd)
+        {
+            struct pollfd list_pollfds[2];
+            list_pollfds[0].fd = m_read_fd;
+            list_pollfds[0].events = POLLIN;
+            list_pollfds[0].revents = 0;
+            list_pollfds[1].fd = fd;
+            list_pollfds[1].events = POLLIN;
+            list_pollfds[1].revents = 0;
+
+            nfds_t const count = (fd < 0) ? 1 : 2;
+            // A negative timeout blocks indefinitely
+            int const timeout_ms =
+                    (timeout.count() < 0 ||
+                     timeout.count() > std::numeric_limits<int>::max()) ?
+                        -1 : static_cast<int>(timeout.count());
+
+            int result;
+            do {
+                result = poll(list_pollfds,count,timeout_ms);
+            }
+            while(result < 0 && errno == EINTR);
+
+            if(list_pollfds[0].revents & POLLIN) {
+                drain();
+            }
+
+            return (result > 0);
+        }
+
+        void EventWaiter::drain()
+        {
+            u64 buffer[8];
+            while(read(m_read_fd,buffer,sizeof(buffer)) > 0) {
+                // Keep reading until the pipe is empty
+            }
+        }
+
+    #else
+
+        EventWaiter::EventWaiter() :
+            m_woken(false)
+        {}
+
+        EventWaiter::~EventWaiter()
+        {}
+
+        void EventWaiter::Wake()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_woken = true;
+            }
+            m_cv.notify_one();
+        }
+
+        bool EventWaiter::Wait(Milliseconds timeout, int)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            // A negative timeout blocks indefinitely
+            bool woken = true;
+            if(timeout.count() < 0) {
+                m_cv.wait(lock,[this](){ return m_woken; });
+            }
+            else {
+                woken = m_cv.wait_for(
+                            lock,
+                            timeout,
+                            [this](){ return m_woken; });
+            }
+
+            m_woken = false;
+            return woken;
+        }
+
+    #endif
+
+        // ============================================================= //
+    }
+}
@@ -0,0 +1,84 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_EVENT_WAITER_HPP
+#define KS_GUI_EVENT_WAITER_HPP
+
+#include <ks/KsGlobal.hpp>
+#include <mutex>
+#include <condition_variable>
+
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+    #define KS_GUI_EVENT_WAITER_POLL 1
+#endif
+
+namespace ks
+{
+    namespace gui
+    {
+        // ============================================================= //
+
+        class EventWaiterInitFailed : public ks::Exception
+        {
+        public:
+            EventWaiterInitFailed(std::string msg);
+            ~EventWaiterInitFailed() = default;
+        };
+
+        // ============================================================= //
+
+        // * Lets a thread sleep until it's woken by another
+        //   thread, a file descriptor becomes readable or a
+        //   timeout expires
+        // * Uses an eventfd on Linux, a pipe on other POSIX
+        //   systems and a condition variable otherwise (where
+        //   waiting on a file descriptor isn't supported)
+        class EventWaiter final
+        {
+        public:
+            EventWaiter();
+            ~EventWaiter();
+
+            // * Wakes the current or next call to Wait
+            // * Thread safe
+            void Wake();
+
+            // * Blocks until Wake is called, @fd is readable
+            //   or @timeout expires. Pass -1 to only wait for
+            //   Wake or the timeout.
+            // * A negative @timeout blocks until Wake is called
+            //   or @fd is readable
+            // * Returns false if the timeout expired
+            bool Wait(Milliseconds timeout, int fd=-1);
+
+        private:
+        #ifdef KS_GUI_EVENT_WAITER_POLL
+            void drain();
+
+            int m_read_fd;
+            int m_write_fd;
+        #else
+            std::mutex m_mutex;
+            std::condition_variable m_cv;
+            bool m_woken;
+        #endif
+        };
+
+        // ============================================================= //
+    }
+}
+
+#endif // KS_GUI_EVENT_WAITER_HPP
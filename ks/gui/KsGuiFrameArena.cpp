@@ -0,0 +1,191 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include <ks/gui/KsGuiFrameArena.hpp>
+#include <cstdint>
+#include <algorithm>
+
+namespace ks
+{
+    namespace gui
+    {
+        namespace {
+            std::size_t AlignOffset(u8 const * data,
+                                    std::size_t offset,
+                                    std::size_t align)
+            {
+                std::uintptr_t const address =
+                        reinterpret_cast<std::uintptr_t>(data)+offset;
+
+                std::uintptr_t const aligned =
+                        (address+(align-1)) & ~(std::uintptr_t(align)-1);
+
+                return offset+static_cast<std::size_t>(aligned-address);
+            }
+        }
+
+        // ============================================================= //
+
+        FrameArena::FrameArena(std::size_t block_size) :
+            m_block_size(std::max<std::size_t>(block_size,256)),
+            m_current(0)
+        {
+            for(auto& half : m_list_halves) {
+                half.block_index = 0;
+                half.offset = 0;
+                half.allocated = 0;
+            }
+
+            m_stats.frames = 0;
+            m_stats.last_frame_size = 0;
+            m_stats.high_water_mark = 0;
+            m_stats.capacity = 0;
+            m_stats.overflow_blocks = 0;
+        }
+
+        void* FrameArena::Allocate(std::size_t size, std::size_t align)
+        {
+            Half& half = m_list_halves[m_current];
+            half.allocated += size;
+
+            if(half.block_index < half.list_blocks.size()) {
+                Block& block = half.list_blocks[half.block_index];
+                std::size_t const offset =
+                        AlignOffset(block.data.get(),half.offset,align);
+
+                if(offset+size <= block.size) {
+                    half.offset = offset+size;
+                    return block.data.get()+offset;
+                }
+            }
+
+            return allocateSlow(size,align);
+        }
+
+        void FrameArena::EndFrame()
+        {
+            std::size_t const frame_size = m_list_halves[m_current].allocated;
+
+            m_current ^= 1;
+            resetHalf(m_list_halves[m_current]);
+
+            std::size_t capacity = 0;
+            for(auto const &half : m_list_halves) {
+                for(auto const &block : half.list_blocks) {
+                    capacity += block.size;
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(m_stats_mutex);
+            m_stats.frames++;
+            m_stats.last_frame_size = frame_size;
+            m_stats.high_water_mark = std::max(m_stats.high_water_mark,frame_size);
+            m_stats.capacity = capacity;
+        }
+
+        void FrameArena::Clear()
+        {
+            for(auto& half : m_list_halves) {
+                half.list_blocks.clear();
+                half.block_index = 0;
+                half.offset = 0;
+                half.allocated = 0;
+            }
+
+            std::lock_guard<std::mutex> lock(m_stats_mutex);
+            m_stats.capacity = 0;
+        }
+
+        FrameArena::Stats FrameArena::GetStats() const
+        {
+            std::lock_guard<std::mutex> lock(m_stats_mutex);
+            return m_stats;
+        }
+
+        void FrameArena::ResetStats()
+        {
+            std::lock_guard<std::mutex> lock(m_stats_mutex);
+            m_stats.frames = 0;
+            m_stats.last_frame_size = 0;
+            m_stats.high_water_mark = 0;
+            m_stats.overflow_blocks = 0;
+        }
+
+        void* FrameArena::allocateSlow(std::size_t size, std::size_t align)
+        {
+            Half& half = m_list_halves[m_current];
+
+            // Move on to the next block that fits, skipping
+            // the rest of the current one
+            while(half.list_blocks.size() > half.block_index+1) {
+                half.block_index++;
+                half.offset = 0;
+
+                Block& block = half.list_blocks[half.block_index];
+                std::size_t const offset = AlignOffset(block.data.get(),0,align);
+                if(offset+size <= block.size) {
+                    half.offset = offset+size;
+                    return block.data.get()+offset;
+                }
+            }
+
+            // Out of memory; add a block with room for at
+            // least this allocation
+            Block block;
+            block.size = std::max(m_block_size,size+align);
+            block.data.reset(new u8[block.size]);
+
+            half.list_blocks.push_back(std::move(block));
+            half.block_index = half.list_blocks.size()-1;
+
+            Block& back = half.list_blocks.back();
+            std::size_t const offset = AlignOffset(back.data.get(),0,align);
+            half.offset = offset+size;
+
+            {
+                std::lock_guard<std::mutex> lock(m_stats_mutex);
+                m_stats.overflow_blocks++;
+            }
+
+            return back.data.get()+offset;
+        }
+
+        void FrameArena::resetHalf(Half& half)
+        {
+            // Merge the blocks so the next frame fits in one
+            if(half.list_blocks.size() > 1) {
+                std::size_t size = 0;
+                for(auto const &block : half.list_blocks) {
+                    size += block.size;
+                }
+
+                half.list_blocks.clear();
+
+                Block block;
+                block.size = size;
+                block.data.reset(new u8[size]);
+                half.list_blocks.push_back(std::move(block));
+            }
+
+            half.block_index = 0;
+            half.offset = 0;
+            half.allocated = 0;
+        }
+
+        // ============================================================= //
+    }
+}
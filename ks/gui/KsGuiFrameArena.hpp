@@ -0,0 +1,190 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef KS_GUI_FRAME_ARENA_HPP
+#define KS_GUI_FRAME_ARENA_HPP
+
+#include <mutex>
+#include <cstddef>
+#include <vector>
+#include <memory>
+#include <ks/KsGlobal.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        // ============================================================= //
+
+        // * A bump allocator for data that only lives for a frame
+        //   (draw lists, vertex staging, text runs)
+        // * Allocations can't be freed individually. Everything
+        //   allocated during a frame is released together two
+        //   calls to EndFrame later, so the data stays valid while
+        //   the frame after it is built (ie. while the GPU may
+        //   still be reading from it)
+        // * Each half of the arena keeps its memory between frames.
+        //   When a frame overflows into more blocks they're merged
+        //   into one block big enough for the whole frame the next
+        //   time that half is reset. Steady state frames then do
+        //   no heap allocations.
+        // * Not thread safe except for GetStats and ResetStats
+        class FrameArena final
+        {
+        public:
+            static std::size_t const DefaultBlockSize = 64*1024;
+
+            struct Stats final
+            {
+                // * Frames ended
+                u64 frames;
+
+                // * Bytes allocated during the last frame
+                std::size_t last_frame_size;
+
+                // * Most bytes allocated during any frame
+                std::size_t high_water_mark;
+
+                // * Memory held by both halves of the arena
+                std::size_t capacity;
+
+                // * Blocks allocated because a frame didn't fit
+                //   in the memory already held
+                u64 overflow_blocks;
+            };
+
+            FrameArena(std::size_t block_size=DefaultBlockSize);
+            ~FrameArena() = default;
+
+            FrameArena(FrameArena const &) = delete;
+            FrameArena& operator=(FrameArena const &) = delete;
+
+            // * Returns @size bytes aligned to @align, which
+            //   must be a power of two
+            void* Allocate(std::size_t size,
+                           std::size_t align=alignof(std::max_align_t));
+
+            template<typename T>
+            T* Allocate(std::size_t count)
+            {
+                return static_cast<T*>(Allocate(count*sizeof(T),alignof(T)));
+            }
+
+            // * Switches to the other half of the arena and
+            //   releases what was allocated in it
+            void EndFrame();
+
+            // * Releases everything and frees all memory
+            void Clear();
+
+            // * Thread safe
+            Stats GetStats() const;
+            void ResetStats();
+
+        private:
+            struct Block
+            {
+                std::unique_ptr<u8[]> data;
+                std::size_t size;
+            };
+
+            struct Half
+            {
+                std::vector<Block> list_blocks;
+                std::size_t block_index;
+                std::size_t offset;
+                std::size_t allocated;
+            };
+
+            void* allocateSlow(std::size_t size, std::size_t align);
+            void resetHalf(Half& half);
+
+            std::size_t const m_block_size;
+
+            Half m_list_halves[2];
+            uint m_current;
+
+            mutable std::mutex m_stats_mutex;
+            Stats m_stats;
+        };
+
+        // ============================================================= //
+
+        // * An STL allocator that allocates from a FrameArena,
+        //   ie. std::vector<T,FrameArenaAllocator<T>>
+        // * deallocate does nothing; containers must not
+        //   outlive the frame after the one they were used in
+        template<typename T>
+        class FrameArenaAllocator
+        {
+        public:
+            using value_type = T;
+
+            template<typename U>
+            struct rebind
+            {
+                using other = FrameArenaAllocator<U>;
+            };
+
+            FrameArenaAllocator(FrameArena& arena) :
+                m_arena(&arena)
+            {}
+
+            template<typename U>
+            FrameArenaAllocator(FrameArenaAllocator<U> const &other) :
+                m_arena(other.GetArena())
+            {}
+
+            T* allocate(std::size_t count)
+            {
+                return m_arena->Allocate<T>(count);
+            }
+
+            void deallocate(T*, std::size_t)
+            {}
+
+            FrameArena* GetArena() const
+            {
+                return m_arena;
+            }
+
+        private:
+            FrameArena* m_arena;
+        };
+
+        template<typename T, typename U>
+        bool operator==(FrameArenaAllocator<T> const &a,
+                        FrameArenaAllocator<U> const &b)
+        {
+            return (a.GetArena() == b.GetArena());
+        }
+
+        template<typename T, typename U>
+        bool operator!=(FrameArenaAllocator<T> const &a,
+                        FrameArenaAllocator<U> const &b)
+        {
+            return !(a == b);
+        }
+
+        template<typename T>
+        using FrameVector = std::vector<T,FrameArenaAllocator<T>>;
+
+        // ============================================================= //
+    }
+}
+
+#endif // KS_GUI_FRAME_ARENA_HPP
@@ -0,0 +1,273 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <ks/gui/KsGuiFramePacer.hpp>
+#include <algorithm>
+#include <cstring>
+
+namespace ks
+{
+    namespace gui
+    {
+        namespace {
+        #ifdef KS_GUI_FRAME_PACER_FENCES
+            // * Fence waits are split into slices so that
+            //   a lost context can't hang the render thread
+            GLuint64 const FenceWaitSliceNs = 100*1000*1000;
+            uint const FenceWaitMaxSlices = 20;
+
+            // * Must be called with the context current
+            bool GetContextHasFences()
+            {
+                char const * version =
+                        reinterpret_cast<char const *>(glGetString(GL_VERSION));
+
+                if(version == nullptr) {
+                    return false;
+                }
+
+                // ie. "OpenGL ES 3.0 ..." or "3.2.0 ..."
+                char const * const es_prefix = "OpenGL ES";
+                bool const es = (std::strncmp(version,es_prefix,
+                                              std::strlen(es_prefix)) == 0);
+
+                while(*version != '\0' && (*version < '0' || *version > '9')) {
+                    version++;
+                }
+
+                uint major = 0;
+                uint minor = 0;
+                for(; *version >= '0' && *version <= '9'; version++) {
+                    major = major*10 + static_cast<uint>(*version-'0');
+                }
+                if(*version == '.') {
+                    version++;
+                    for(; *version >= '0' && *version <= '9'; version++) {
+                        minor = minor*10 + static_cast<uint>(*version-'0');
+                    }
+                }
+
+                if(es) {
+                    return (major >= 3);
+                }
+
+                if(major > 3 || (major == 3 && minor >= 2)) {
+                    return true;
+                }
+
+                // Older desktop contexts can still list the
+                // extension in GL_EXTENSIONS
+                char const * extensions =
+                        reinterpret_cast<char const *>(glGetString(GL_EXTENSIONS));
+
+                return (extensions != nullptr &&
+                        std::strstr(extensions,"GL_ARB_sync") != nullptr);
+            }
+        #endif
+        }
+
+        // ============================================================= //
+
+        uint const FramePacer::MaxFramesInFlight;
+
+        FramePacer::FramePacer() :
+            m_max_frames(MaxFramesInFlight)
+        {
+        #ifdef KS_GUI_FRAME_PACER_FENCES
+            m_fences_checked = false;
+            m_fences_supported = false;
+
+            for(auto& fence : m_list_fences) {
+                fence = nullptr;
+            }
+            m_fence_head = 0;
+            m_fence_count = 0;
+        #endif
+
+            ResetStats();
+        }
+
+        void FramePacer::SetMaxFramesInFlight(uint count)
+        {
+            m_max_frames = std::max(1u,std::min(count,MaxFramesInFlight));
+        }
+
+        uint FramePacer::GetMaxFramesInFlight() const
+        {
+            return m_max_frames;
+        }
+
+        void FramePacer::OnSwapBuffers()
+        {
+            uint const max_frames = m_max_frames;
+
+        #ifdef KS_GUI_FRAME_PACER_FENCES
+            if(!m_fences_checked) {
+                m_fences_checked = true;
+                m_fences_supported = GetContextHasFences();
+
+                if(!m_fences_supported) {
+                    LOG.Trace() << "FramePacer: context doesn't support "
+                                   "fences, frames in flight aren't limited";
+                }
+            }
+
+            if(m_fences_supported) {
+                recordWait(waitForFences(max_frames));
+                return;
+            }
+        #endif
+
+            // Without fences the only limit that can be
+            // enforced is waiting for the whole frame
+            Microseconds wait(0);
+
+            if(max_frames == 1) {
+                TimePoint const wait_start = std::chrono::steady_clock::now();
+                glFinish();
+                wait = std::chrono::duration_cast<Microseconds>(
+                            std::chrono::steady_clock::now()-wait_start);
+            }
+
+            recordWait(wait);
+        }
+
+        bool FramePacer::GetHasPendingFrames() const
+        {
+        #ifdef KS_GUI_FRAME_PACER_FENCES
+            return (m_fence_count > 0);
+        #else
+            return false;
+        #endif
+        }
+
+        void FramePacer::Release()
+        {
+        #ifdef KS_GUI_FRAME_PACER_FENCES
+            while(m_fence_count > 0) {
+                glDeleteSync(m_list_fences[m_fence_head]);
+                m_list_fences[m_fence_head] = nullptr;
+                m_fence_head = (m_fence_head+1)%MaxFramesInFlight;
+                m_fence_count--;
+            }
+            m_fence_head = 0;
+            m_fences_checked = false;
+        #endif
+        }
+
+        void FramePacer::Discard()
+        {
+        #ifdef KS_GUI_FRAME_PACER_FENCES
+            for(auto& fence : m_list_fences) {
+                fence = nullptr;
+            }
+            m_fence_head = 0;
+            m_fence_count = 0;
+            m_fences_checked = false;
+        #endif
+        }
+
+        FramePacer::Stats FramePacer::GetStats() const
+        {
+            std::lock_guard<std::mutex> lock(m_stats_mutex);
+            return m_stats;
+        }
+
+        void FramePacer::ResetStats()
+        {
+            std::lock_guard<std::mutex> lock(m_stats_mutex);
+            m_stats.frames = 0;
+            m_stats.waited_frames = 0;
+            m_stats.last_wait = Microseconds(0);
+            m_stats.max_wait = Microseconds(0);
+            m_stats.total_wait = Microseconds(0);
+        }
+
+        #ifdef KS_GUI_FRAME_PACER_FENCES
+        Microseconds FramePacer::waitForFences(uint max_frames)
+        {
+            // Add a fence for the frame that was just swapped
+            uint const tail = (m_fence_head+m_fence_count)%MaxFramesInFlight;
+            m_list_fences[tail] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0);
+            m_fence_count++;
+
+            // Wait for the oldest frames until fewer than
+            // max_frames are left, so that the next frame
+            // can be queued without exceeding the limit
+            TimePoint const wait_start = std::chrono::steady_clock::now();
+            bool waited = false;
+
+            while(m_fence_count >= max_frames)
+            {
+                GLsync& fence = m_list_fences[m_fence_head];
+
+                // The first wait flushes the fence so that it's
+                // guaranteed to eventually be signaled
+                GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+
+                for(uint i=0; i < FenceWaitMaxSlices; i++) {
+                    GLenum const result =
+                            glClientWaitSync(fence,flags,FenceWaitSliceNs);
+
+                    if(result == GL_ALREADY_SIGNALED) {
+                        break;
+                    }
+
+                    waited = true;
+
+                    if(result == GL_CONDITION_SATISFIED) {
+                        break;
+                    }
+                    else if(result == GL_WAIT_FAILED) {
+                        LOG.Warn() << "FramePacer: fence wait failed";
+                        break;
+                    }
+
+                    flags = 0;
+                }
+
+                glDeleteSync(fence);
+                fence = nullptr;
+                m_fence_head = (m_fence_head+1)%MaxFramesInFlight;
+                m_fence_count--;
+            }
+
+            Microseconds wait(0);
+            if(waited) {
+                wait = std::chrono::duration_cast<Microseconds>(
+                            std::chrono::steady_clock::now()-wait_start);
+            }
+
+            return wait;
+        }
+        #endif
+
+        void FramePacer::recordWait(Microseconds wait)
+        {
+            std::lock_guard<std::mutex> lock(m_stats_mutex);
+            m_stats.frames++;
+            m_stats.last_wait = wait;
+            m_stats.total_wait += wait;
+
+            if(wait.count() > 0) {
+                m_stats.waited_frames++;
+                m_stats.max_wait = std::max(m_stats.max_wait,wait);
+            }
+        }
+
+        // ============================================================= //
+    }
+}
@@ -0,0 +1,130 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_FRAME_PACER_HPP
+#define KS_GUI_FRAME_PACER_HPP
+
+#include <mutex>
+#include <ks/KsGlobal.hpp>
+#include <ks/gl/KsGLConfig.hpp>
+
+#if defined(GL_SYNC_GPU_COMMANDS_COMPLETE)
+    #define KS_GUI_FRAME_PACER_FENCES 1
+#endif
+
+namespace ks
+{
+    namespace gui
+    {
+        // ============================================================= //
+
+        // * Limits how many frames the CPU can queue ahead of
+        //   the GPU by inserting a fence after each swap and
+        //   waiting on the oldest one when the limit is reached
+        // * A limit of 1 gives the lowest latency (the CPU waits
+        //   for each frame to finish); 3 gives the most
+        //   throughput
+        // * Fences are only used if the context supports them
+        //   (GL 3.2, GLES 3 or ARB_sync), which is checked the
+        //   first time a frame is swapped. Without them (ie.
+        //   GLES 2 or a plain GL 2.1 context) only a limit of 1
+        //   can be enforced, which falls back to glFinish;
+        //   larger limits don't pace at all.
+        class FramePacer final
+        {
+        public:
+            static uint const MaxFramesInFlight = 3;
+
+            struct Stats final
+            {
+                // * Frames swapped
+                u64 frames;
+
+                // * Frames that had to wait for the GPU
+                u64 waited_frames;
+
+                // * Time the last frame spent waiting
+                Microseconds last_wait;
+
+                // * Longest and total time spent waiting
+                Microseconds max_wait;
+                Microseconds total_wait;
+            };
+
+            FramePacer();
+            ~FramePacer() = default;
+
+            // * @count is clamped to [1,MaxFramesInFlight]
+            // * Defaults to MaxFramesInFlight
+            // * Thread safe
+            void SetMaxFramesInFlight(uint count);
+            uint GetMaxFramesInFlight() const;
+
+            // * Must be called with the context current right
+            //   after its buffers have been swapped
+            // * Blocks until no more than the allowed number of
+            //   frames are in flight
+            void OnSwapBuffers();
+
+            // * Returns true if there are fences that must be
+            //   deleted with Release
+            bool GetHasPendingFrames() const;
+
+            // * Deletes any pending fences. Must be called with
+            //   the context current before it's released
+            void Release();
+
+            // * Forgets pending fences without deleting them,
+            //   for when the context has been lost
+            void Discard();
+
+            // * Thread safe
+            Stats GetStats() const;
+            void ResetStats();
+
+        private:
+            void recordWait(Microseconds wait);
+
+        #ifdef KS_GUI_FRAME_PACER_FENCES
+            // * Fences the swapped frame and returns how long
+            //   it waited for older frames
+            Microseconds waitForFences(uint max_frames);
+        #endif
+
+            std::atomic<uint> m_max_frames;
+
+        #ifdef KS_GUI_FRAME_PACER_FENCES
+            // * Whether the current context supports fences;
+            //   checked again after Release or Discard since
+            //   the next context may be different
+            bool m_fences_checked;
+            bool m_fences_supported;
+
+            // * Ring of fences, oldest first
+            GLsync m_list_fences[MaxFramesInFlight];
+            uint m_fence_head;
+            uint m_fence_count;
+        #endif
+
+            mutable std::mutex m_stats_mutex;
+            Stats m_stats;
+        };
+
+        // ============================================================= //
+    }
+}
+
+#endif // KS_GUI_FRAME_PACER_HPP
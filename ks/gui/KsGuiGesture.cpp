@@ -0,0 +1,489 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <ks/gui/KsGuiGesture.hpp>
+#include <cmath>
+
+namespace ks
+{
+    namespace gui
+    {
+        namespace {
+            float GetSeconds(TimePoint::duration const &duration)
+            {
+                return std::chrono::duration<float>(duration).count();
+            }
+
+            float GetLength(float x, float y)
+            {
+                return std::sqrt(x*x + y*y);
+            }
+        }
+
+        // ============================================================= //
+
+        GestureRecognizer::GestureRecognizer(ks::Object::Key const &key,
+                                             shared_ptr<EventLoop> event_loop,
+                                             Config config) :
+            ks::Object(key,event_loop),
+            m_config(config),
+            m_active_count(0),
+            m_mode(Mode::None),
+            m_primary_index(0),
+            m_secondary_index(0),
+            m_long_press_armed(false),
+            m_focus_x(0.0f),
+            m_focus_y(0.0f),
+            m_start_span(0.0f)
+        {
+            for(auto& touch : m_list_touches) {
+                touch.active = false;
+                touch.history_next = 0;
+                touch.history_count = 0;
+            }
+        }
+
+        void GestureRecognizer::Init(ks::Object::Key const &,
+                                     shared_ptr<GestureRecognizer> const &)
+        {}
+
+        GestureRecognizer::~GestureRecognizer()
+        {}
+
+        void GestureRecognizer::ProcessTouchEvent(TouchEvent event)
+        {
+            if(event.index >= MaxTouches) {
+                return;
+            }
+
+            Touch& touch = m_list_touches[event.index];
+
+            // Press
+            if(event.action == TouchEvent::Action::Press)
+            {
+                if(touch.active) {
+                    // Duplicate press for the same finger
+                    return;
+                }
+
+                touch.active = true;
+                touch.start_x = event.x;
+                touch.start_y = event.y;
+                touch.x = event.x;
+                touch.y = event.y;
+                touch.history_next = 0;
+                touch.history_count = 0;
+                addSample(touch,event);
+
+                m_active_count++;
+
+                if(m_active_count == 1)
+                {
+                    m_mode = Mode::Pending;
+                    m_primary_index = event.index;
+                    m_long_press_armed = true;
+                    m_press_time = event.timestamp;
+                    m_focus_x = event.x;
+                    m_focus_y = event.y;
+                }
+                else if(m_active_count == 2)
+                {
+                    // A second finger always starts a pinch
+                    Touch const &primary = m_list_touches[m_primary_index];
+
+                    if(m_mode == Mode::Pan) {
+                        emit(GestureEvent::Type::Pan,
+                             GestureEvent::State::End,
+                             primary.x,primary.y,
+                             0.0f,0.0f,1.0f,0.0f,0.0f,
+                             event.timestamp);
+                    }
+                    else if(m_mode == Mode::LongPress) {
+                        emit(GestureEvent::Type::LongPress,
+                             GestureEvent::State::End,
+                             primary.x,primary.y,
+                             0.0f,0.0f,1.0f,0.0f,0.0f,
+                             event.timestamp);
+                    }
+
+                    m_secondary_index = event.index;
+                    beginPinch(event.timestamp);
+                }
+
+                return;
+            }
+
+            if(!touch.active) {
+                return;
+            }
+
+            touch.x = event.x;
+            touch.y = event.y;
+            addSample(touch,event);
+
+            // Release
+            if(event.action == TouchEvent::Action::Release)
+            {
+                touch.active = false;
+                m_active_count--;
+
+                bool const primary = (event.index == m_primary_index);
+
+                if(m_mode == Mode::Pan && primary)
+                {
+                    float vx,vy;
+                    estimateVelocity(touch,vx,vy);
+
+                    emit(GestureEvent::Type::Pan,
+                         GestureEvent::State::End,
+                         touch.x,touch.y,
+                         touch.x-m_focus_x,touch.y-m_focus_y,
+                         1.0f,vx,vy,
+                         event.timestamp);
+
+                    if(GetLength(vx,vy) >= m_config.fling_min_velocity) {
+                        emit(GestureEvent::Type::Fling,
+                             GestureEvent::State::End,
+                             touch.x,touch.y,
+                             0.0f,0.0f,1.0f,vx,vy,
+                             event.timestamp);
+                    }
+
+                    m_mode = Mode::None;
+                }
+                else if(m_mode == Mode::LongPress && primary)
+                {
+                    emit(GestureEvent::Type::LongPress,
+                         GestureEvent::State::End,
+                         touch.x,touch.y,
+                         touch.x-m_focus_x,touch.y-m_focus_y,
+                         1.0f,0.0f,0.0f,
+                         event.timestamp);
+
+                    m_mode = Mode::None;
+                }
+                else if(m_mode == Mode::Pinch &&
+                        (primary || event.index == m_secondary_index))
+                {
+                    float x,y,span;
+                    getPinchFocus(x,y,span);
+
+                    emit(GestureEvent::Type::Pinch,
+                         GestureEvent::State::End,
+                         x,y,x-m_focus_x,y-m_focus_y,
+                         span/m_start_span,0.0f,0.0f,
+                         event.timestamp);
+
+                    m_mode = Mode::None;
+
+                    // Let a remaining finger start a new pan
+                    for(uint i=0; i < MaxTouches; i++)
+                    {
+                        Touch& other = m_list_touches[i];
+                        if(other.active) {
+                            other.start_x = other.x;
+                            other.start_y = other.y;
+                            m_mode = Mode::Pending;
+                            m_primary_index = static_cast<u8>(i);
+                            m_long_press_armed = false;
+                            m_focus_x = other.x;
+                            m_focus_y = other.y;
+                            break;
+                        }
+                    }
+                }
+                else if(m_mode == Mode::Pending && primary)
+                {
+                    m_mode = Mode::None;
+                }
+
+                if(m_active_count == 0) {
+                    m_mode = Mode::None;
+                }
+
+                return;
+            }
+
+            // Motion
+            if(m_mode == Mode::Pinch)
+            {
+                if(event.index != m_primary_index &&
+                   event.index != m_secondary_index)
+                {
+                    return;
+                }
+
+                float x,y,span;
+                getPinchFocus(x,y,span);
+
+                emit(GestureEvent::Type::Pinch,
+                     GestureEvent::State::Update,
+                     x,y,x-m_focus_x,y-m_focus_y,
+                     span/m_start_span,0.0f,0.0f,
+                     event.timestamp);
+
+                m_focus_x = x;
+                m_focus_y = y;
+                return;
+            }
+
+            if(event.index != m_primary_index) {
+                return;
+            }
+
+            if(m_mode == Mode::Pending)
+            {
+                float const dist =
+                        GetLength(touch.x-touch.start_x,
+                                  touch.y-touch.start_y);
+
+                if(dist > m_config.touch_slop)
+                {
+                    m_mode = Mode::Pan;
+
+                    float vx,vy;
+                    estimateVelocity(touch,vx,vy);
+
+                    emit(GestureEvent::Type::Pan,
+                         GestureEvent::State::Begin,
+                         touch.x,touch.y,
+                         touch.x-m_focus_x,touch.y-m_focus_y,
+                         1.0f,vx,vy,
+                         event.timestamp);
+
+                    m_focus_x = touch.x;
+                    m_focus_y = touch.y;
+                }
+                else
+                {
+                    checkLongPress(event.timestamp);
+                }
+            }
+            else if(m_mode == Mode::Pan || m_mode == Mode::LongPress)
+            {
+                float vx=0.0f;
+                float vy=0.0f;
+                if(m_mode == Mode::Pan) {
+                    estimateVelocity(touch,vx,vy);
+                }
+
+                emit((m_mode == Mode::Pan) ?
+                        GestureEvent::Type::Pan :
+                        GestureEvent::Type::LongPress,
+                     GestureEvent::State::Update,
+                     touch.x,touch.y,
+                     touch.x-m_focus_x,touch.y-m_focus_y,
+                     1.0f,vx,vy,
+                     event.timestamp);
+
+                m_focus_x = touch.x;
+                m_focus_y = touch.y;
+            }
+        }
+
+        void GestureRecognizer::Update(TimePoint now)
+        {
+            checkLongPress(now);
+        }
+
+        void GestureRecognizer::Reset()
+        {
+            TimePoint const now = std::chrono::steady_clock::now();
+
+            if(m_mode == Mode::Pan) {
+                emit(GestureEvent::Type::Pan,
+                     GestureEvent::State::End,
+                     m_focus_x,m_focus_y,
+                     0.0f,0.0f,1.0f,0.0f,0.0f,
+                     now);
+            }
+            else if(m_mode == Mode::Pinch) {
+                emit(GestureEvent::Type::Pinch,
+                     GestureEvent::State::End,
+                     m_focus_x,m_focus_y,
+                     0.0f,0.0f,1.0f,0.0f,0.0f,
+                     now);
+            }
+            else if(m_mode == Mode::LongPress) {
+                emit(GestureEvent::Type::LongPress,
+                     GestureEvent::State::End,
+                     m_focus_x,m_focus_y,
+                     0.0f,0.0f,1.0f,0.0f,0.0f,
+                     now);
+            }
+
+            for(auto& touch : m_list_touches) {
+                touch.active = false;
+                touch.history_next = 0;
+                touch.history_count = 0;
+            }
+
+            m_active_count = 0;
+            m_mode = Mode::None;
+            m_long_press_armed = false;
+        }
+
+        void GestureRecognizer::addSample(Touch& touch,
+                                          TouchEvent const &event)
+        {
+            Sample& sample = touch.list_history[touch.history_next];
+            sample.x = event.x;
+            sample.y = event.y;
+            sample.timestamp = event.timestamp;
+
+            touch.history_next = (touch.history_next+1)%HistorySize;
+            if(touch.history_count < HistorySize) {
+                touch.history_count++;
+            }
+        }
+
+        void GestureRecognizer::estimateVelocity(Touch const &touch,
+                                                 float& vx,
+                                                 float& vy) const
+        {
+            vx = 0.0f;
+            vy = 0.0f;
+
+            if(touch.history_count < 2) {
+                return;
+            }
+
+            // Least squares fit of a line to the recent samples
+            // for each axis; the slope is the velocity. Times are
+            // relative to the newest sample to keep precision.
+            uint const newest =
+                    (touch.history_next+HistorySize-1)%HistorySize;
+
+            TimePoint const t0 = touch.list_history[newest].timestamp;
+            float const horizon = GetSeconds(m_config.velocity_horizon);
+
+            float n=0.0f;
+            float sum_t=0.0f;
+            float sum_tt=0.0f;
+            float sum_x=0.0f;
+            float sum_y=0.0f;
+            float sum_tx=0.0f;
+            float sum_ty=0.0f;
+
+            for(uint i=0; i < touch.history_count; i++)
+            {
+                Sample const &sample =
+                        touch.list_history[(newest+HistorySize-i)%HistorySize];
+
+                float const t = GetSeconds(sample.timestamp-t0);
+                if(-t > horizon) {
+                    break;
+                }
+
+                n += 1.0f;
+                sum_t += t;
+                sum_tt += t*t;
+                sum_x += sample.x;
+                sum_y += sample.y;
+                sum_tx += t*sample.x;
+                sum_ty += t*sample.y;
+            }
+
+            float const denom = n*sum_tt - sum_t*sum_t;
+            if(n < 2.0f || !(denom > 1E-12f)) {
+                return;
+            }
+
+            vx = (n*sum_tx - sum_t*sum_x)/denom;
+            vy = (n*sum_ty - sum_t*sum_y)/denom;
+        }
+
+        void GestureRecognizer::checkLongPress(TimePoint now)
+        {
+            if(m_mode != Mode::Pending || !m_long_press_armed) {
+                return;
+            }
+
+            if(now-m_press_time < m_config.long_press_timeout) {
+                return;
+            }
+
+            m_mode = Mode::LongPress;
+            m_long_press_armed = false;
+
+            Touch const &touch = m_list_touches[m_primary_index];
+            m_focus_x = touch.x;
+            m_focus_y = touch.y;
+
+            emit(GestureEvent::Type::LongPress,
+                 GestureEvent::State::Begin,
+                 touch.x,touch.y,
+                 0.0f,0.0f,1.0f,0.0f,0.0f,
+                 now);
+        }
+
+        void GestureRecognizer::beginPinch(TimePoint timestamp)
+        {
+            m_mode = Mode::Pinch;
+
+            float x,y,span;
+            getPinchFocus(x,y,span);
+
+            m_focus_x = x;
+            m_focus_y = y;
+
+            // Avoid dividing by zero for coincident fingers
+            m_start_span = (span > 1.0f) ? span : 1.0f;
+
+            emit(GestureEvent::Type::Pinch,
+                 GestureEvent::State::Begin,
+                 x,y,0.0f,0.0f,1.0f,0.0f,0.0f,
+                 timestamp);
+        }
+
+        void GestureRecognizer::getPinchFocus(float& x,
+                                              float& y,
+                                              float& span) const
+        {
+            Touch const &a = m_list_touches[m_primary_index];
+            Touch const &b = m_list_touches[m_secondary_index];
+
+            x = 0.5f*(a.x+b.x);
+            y = 0.5f*(a.y+b.y);
+            span = GetLength(a.x-b.x,a.y-b.y);
+        }
+
+        void GestureRecognizer::emit(GestureEvent::Type type,
+                                     GestureEvent::State state,
+                                     float x,float y,
+                                     float dx,float dy,
+                                     float scale,
+                                     float vx,float vy,
+                                     TimePoint timestamp)
+        {
+            GestureEvent event;
+            event.type = type;
+            event.state = state;
+            event.x = x;
+            event.y = y;
+            event.dx = dx;
+            event.dy = dy;
+            event.scale = scale;
+            event.vx = vx;
+            event.vy = vy;
+            event.timestamp = timestamp;
+
+            signal_gesture.Emit(event);
+        }
+
+        // ============================================================= //
+    }
+}
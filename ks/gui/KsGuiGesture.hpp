@@ -0,0 +1,206 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_GESTURE_HPP
+#define KS_GUI_GESTURE_HPP
+
+#include <ks/KsObject.hpp>
+#include <ks/KsSignal.hpp>
+#include <ks/gui/KsGuiInput.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        // ============================================================= //
+
+        struct GestureEvent
+        {
+            enum class Type : u8
+            {
+                Pan,
+                Pinch,
+                Fling,
+                LongPress
+            };
+
+            enum class State : u8
+            {
+                Begin,
+                Update,
+                End
+            };
+
+            Type type;
+            State state;
+
+            // * Focal point (the centroid for Pinch)
+            float x;
+            float y;
+
+            // * Change in the focal point since the
+            //   last event for this gesture
+            float dx;
+            float dy;
+
+            // * Pinch: current span / span at Begin
+            //   Otherwise: 1
+            float scale;
+
+            // * Velocity in units per second estimated from
+            //   recent samples (Pan, Fling)
+            float vx;
+            float vy;
+
+            TimePoint timestamp;
+        };
+
+        // ============================================================= //
+
+        // * Recognizes pan, pinch, fling and long press gestures
+        //   from a stream of TouchEvents
+        // * A TouchEvent with Action::None is treated as motion
+        // * Processing an event takes constant time and does
+        //   not allocate; all per-finger state is fixed size
+        class GestureRecognizer final : public ks::Object
+        {
+        public:
+            using base_type = ks::Object;
+
+            // * Fingers with an index >= MaxTouches are ignored
+            static uint const MaxTouches = 10;
+
+            // * Samples kept per finger for velocity estimation
+            static uint const HistorySize = 8;
+
+            struct Config final
+            {
+                Config() :
+                    touch_slop(8.0f),
+                    long_press_timeout(500),
+                    fling_min_velocity(300.0f),
+                    velocity_horizon(100)
+                {}
+
+                // * Distance a finger may move before a
+                //   press becomes a pan
+                float touch_slop;
+
+                // * Time a finger must be held within touch_slop
+                //   to be recognized as a long press
+                Milliseconds long_press_timeout;
+
+                // * Minimum release speed for a pan to also
+                //   produce a fling
+                float fling_min_velocity;
+
+                // * Only samples this recent are used to
+                //   estimate velocity
+                Milliseconds velocity_horizon;
+            };
+
+            GestureRecognizer(ks::Object::Key const &key,
+                              shared_ptr<EventLoop> event_loop,
+                              Config config=Config());
+
+            void Init(ks::Object::Key const &,
+                      shared_ptr<GestureRecognizer> const &);
+
+            ~GestureRecognizer();
+
+            // * Feeds the next touch event to the recognizer
+            // * Can be connected directly to Application::
+            //   signal_touch_input
+            void ProcessTouchEvent(TouchEvent event);
+
+            // * Long presses are otherwise only detected when
+            //   a touch event arrives; call this periodically
+            //   (ie. once per frame) to detect them while the
+            //   finger is perfectly still
+            void Update(TimePoint now);
+
+            // * Ends any active gesture and clears all fingers
+            void Reset();
+
+            Signal<GestureEvent> signal_gesture;
+
+        private:
+            enum class Mode : u8
+            {
+                None,
+                Pending,
+                Pan,
+                Pinch,
+                LongPress
+            };
+
+            struct Sample
+            {
+                float x;
+                float y;
+                TimePoint timestamp;
+            };
+
+            struct Touch
+            {
+                bool active;
+                float start_x;
+                float start_y;
+                float x;
+                float y;
+                Sample list_history[HistorySize];
+                uint history_next;
+                uint history_count;
+            };
+
+            void addSample(Touch& touch,TouchEvent const &event);
+            void estimateVelocity(Touch const &touch,float& vx,float& vy) const;
+            void checkLongPress(TimePoint now);
+
+            void beginPinch(TimePoint timestamp);
+            void getPinchFocus(float& x,float& y,float& span) const;
+
+            void emit(GestureEvent::Type type,
+                      GestureEvent::State state,
+                      float x,float y,
+                      float dx,float dy,
+                      float scale,
+                      float vx,float vy,
+                      TimePoint timestamp);
+
+            Config m_config;
+            Touch m_list_touches[MaxTouches];
+            uint m_active_count;
+
+            Mode m_mode;
+            u8 m_primary_index;
+            u8 m_secondary_index;
+            bool m_long_press_armed;
+            TimePoint m_press_time;
+
+            // * Last reported focal point
+            float m_focus_x;
+            float m_focus_y;
+
+            // * Finger span when the current pinch began
+            float m_start_span;
+        };
+
+        // ============================================================= //
+    }
+}
+
+#endif // KS_GUI_GESTURE_HPP
@@ -0,0 +1,288 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <ks/gui/KsGuiImage.hpp>
+#include <ks/gui/KsGuiShmPlatform.hpp>
+#include <ks/gl/KsGLConfig.hpp>
+#include <fstream>
+#include <cstring>
+
+namespace ks
+{
+    namespace gui
+    {
+        namespace {
+            // * Reads the next header token, skipping comments
+            bool ReadToken(std::istream &stream, std::string &token)
+            {
+                token.clear();
+
+                while(true) {
+                    int const c = stream.get();
+                    if(c == EOF) {
+                        return !token.empty();
+                    }
+
+                    if(c == '#' && token.empty()) {
+                        std::string comment;
+                        std::getline(stream,comment);
+                        continue;
+                    }
+
+                    if(c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+                        if(!token.empty()) {
+                            return true;
+                        }
+                        continue;
+                    }
+
+                    token.push_back(static_cast<char>(c));
+                }
+            }
+
+            bool ReadUint(std::istream &stream, uint &value)
+            {
+                std::string token;
+                if(!ReadToken(stream,token) || token.empty() || token.size() > 9 ||
+                   token.find_first_not_of("0123456789") != std::string::npos)
+                {
+                    return false;
+                }
+
+                value = static_cast<uint>(std::stoul(token));
+                return true;
+            }
+
+            // * Limits the size of images read from files
+            uint const g_max_dimension = 16384;
+        }
+
+        // ============================================================= //
+
+        Image::Image() :
+            width(0),
+            height(0)
+        {}
+
+        Image::Image(uint width, uint height) :
+            width(0),
+            height(0)
+        {
+            Resize(width,height);
+        }
+
+        void Image::Resize(uint new_width, uint new_height)
+        {
+            width = new_width;
+            height = new_height;
+            data.resize(size_t(width)*height*4);
+        }
+
+        u8* Image::GetPixel(uint x, uint y)
+        {
+            return &data[((size_t(y)*width)+x)*4];
+        }
+
+        u8 const * Image::GetPixel(uint x, uint y) const
+        {
+            return &data[((size_t(y)*width)+x)*4];
+        }
+
+        Image Image::FromSurface(SoftwareSurface const &surface)
+        {
+            Image image(surface.width,surface.height);
+
+            for(uint y=0; y < surface.height; y++) {
+                std::memcpy(image.GetPixel(0,y),
+                            surface.data+(size_t(y)*surface.stride),
+                            size_t(surface.width)*4);
+            }
+
+            return image;
+        }
+
+        bool Image::ReadFramebuffer(Image &image,
+                                    uint width,
+                                    uint height)
+        {
+            image.Resize(width,height);
+            if(image.data.empty()) {
+                return false;
+            }
+
+            glPixelStorei(GL_PACK_ALIGNMENT,4);
+            glReadPixels(0,0,
+                         static_cast<GLsizei>(width),
+                         static_cast<GLsizei>(height),
+                         GL_RGBA,
+                         GL_UNSIGNED_BYTE,
+                         &image.data[0]);
+
+            if(glGetError() != GL_NO_ERROR) {
+                return false;
+            }
+
+            // GL rows are bottom to top
+            size_t const row_size = size_t(width)*4;
+            std::vector<u8> row(row_size);
+
+            for(uint y=0; y < height/2; y++) {
+                u8* top = image.GetPixel(0,y);
+                u8* bottom = image.GetPixel(0,height-1-y);
+                std::memcpy(&row[0],top,row_size);
+                std::memcpy(top,bottom,row_size);
+                std::memcpy(bottom,&row[0],row_size);
+            }
+
+            return true;
+        }
+
+        bool Image::ReadFile(std::string const &path, Image &image)
+        {
+            std::ifstream file(path,std::ios::in|std::ios::binary);
+            if(!file) {
+                return false;
+            }
+
+            std::string magic;
+            if(!ReadToken(file,magic)) {
+                return false;
+            }
+
+            uint width = 0;
+            uint height = 0;
+            uint depth = 0;
+            uint max_value = 0;
+
+            if(magic == "P6")
+            {
+                depth = 3;
+                if(!ReadUint(file,width) ||
+                   !ReadUint(file,height) ||
+                   !ReadUint(file,max_value))
+                {
+                    return false;
+                }
+                // ReadToken consumed the single whitespace
+                // character before the pixels
+            }
+            else if(magic == "P7")
+            {
+                std::string token;
+                while(ReadToken(file,token) && token != "ENDHDR") {
+                    if(token == "WIDTH") {
+                        ReadUint(file,width);
+                    }
+                    else if(token == "HEIGHT") {
+                        ReadUint(file,height);
+                    }
+                    else if(token == "DEPTH") {
+                        ReadUint(file,depth);
+                    }
+                    else if(token == "MAXVAL") {
+                        ReadUint(file,max_value);
+                    }
+                    else if(token == "TUPLTYPE") {
+                        ReadToken(file,token);
+                    }
+                }
+
+                if(token != "ENDHDR") {
+                    return false;
+                }
+            }
+            else {
+                return false;
+            }
+
+            if(width == 0 || height == 0 ||
+               width > g_max_dimension || height > g_max_dimension ||
+               max_value != 255 || (depth != 3 && depth != 4))
+            {
+                return false;
+            }
+
+            std::vector<u8> list_pixels(size_t(width)*height*depth);
+            file.read(reinterpret_cast<char*>(&list_pixels[0]),
+                      static_cast<std::streamsize>(list_pixels.size()));
+
+            if(!file) {
+                return false;
+            }
+
+            image.Resize(width,height);
+
+            if(depth == 4) {
+                image.data.swap(list_pixels);
+            }
+            else {
+                size_t const count = size_t(width)*height;
+                for(size_t i=0; i < count; i++) {
+                    image.data[(i*4)+0] = list_pixels[(i*3)+0];
+                    image.data[(i*4)+1] = list_pixels[(i*3)+1];
+                    image.data[(i*4)+2] = list_pixels[(i*3)+2];
+                    image.data[(i*4)+3] = 255;
+                }
+            }
+
+            return true;
+        }
+
+        bool Image::WritePam(std::string const &path) const
+        {
+            std::ofstream file(path,std::ios::out|std::ios::binary|std::ios::trunc);
+            if(!file) {
+                return false;
+            }
+
+            file << "P7\nWIDTH " << width
+                 << "\nHEIGHT " << height
+                 << "\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n";
+
+            file.write(reinterpret_cast<char const *>(data.data()),
+                       static_cast<std::streamsize>(data.size()));
+
+            return file.good();
+        }
+
+        bool Image::WritePpm(std::string const &path) const
+        {
+            std::ofstream file(path,std::ios::out|std::ios::binary|std::ios::trunc);
+            if(!file) {
+                return false;
+            }
+
+            file << "P6\n" << width << " " << height << "\n255\n";
+
+            std::vector<u8> row(size_t(width)*3);
+            for(uint y=0; y < height; y++) {
+                u8 const * pixel = GetPixel(0,y);
+                for(uint x=0; x < width; x++, pixel += 4) {
+                    row[(x*3)+0] = pixel[0];
+                    row[(x*3)+1] = pixel[1];
+                    row[(x*3)+2] = pixel[2];
+                }
+
+                file.write(reinterpret_cast<char const *>(row.data()),
+                           static_cast<std::streamsize>(row.size()));
+            }
+
+            return file.good();
+        }
+
+        // ============================================================= //
+    }
+}
@@ -0,0 +1,75 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_IMAGE_HPP
+#define KS_GUI_IMAGE_HPP
+
+#include <vector>
+#include <ks/KsGlobal.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        struct SoftwareSurface;
+
+        // ============================================================= //
+
+        // * A tightly packed RGBA8888 image, rows top to bottom
+        struct Image final
+        {
+            Image();
+            Image(uint width, uint height);
+
+            void Resize(uint width, uint height);
+
+            u8* GetPixel(uint x, uint y);
+            u8 const * GetPixel(uint x, uint y) const;
+
+            // * Copies the pixels of @surface
+            static Image FromSurface(SoftwareSurface const &surface);
+
+            // * Reads the current framebuffer with glReadPixels
+            // * Must be called on the render thread with the
+            //   context current (ie. from InvokeWithContext),
+            //   before the frame is swapped
+            // * Returns false if reading failed
+            static bool ReadFramebuffer(Image &image,
+                                        uint width,
+                                        uint height);
+
+            // * Reads a binary PAM (P7, RGB or RGB_ALPHA) or
+            //   PPM (P6) file; RGB images are given an opaque
+            //   alpha channel
+            // * Returns false if the file couldn't be read
+            static bool ReadFile(std::string const &path, Image &image);
+
+            // * Writes a PAM file (RGB_ALPHA)
+            bool WritePam(std::string const &path) const;
+
+            // * Writes a PPM file, dropping the alpha channel
+            bool WritePpm(std::string const &path) const;
+
+            uint width;
+            uint height;
+            std::vector<u8> data;
+        };
+
+        // ============================================================= //
+    }
+}
+
+#endif // KS_GUI_IMAGE_HPP
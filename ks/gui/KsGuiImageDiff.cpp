@@ -0,0 +1,259 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <ks/gui/KsGuiImageDiff.hpp>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define KS_GUI_IMAGE_DIFF_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define KS_GUI_IMAGE_DIFF_NEON 1
+#endif
+
+namespace ks
+{
+    namespace gui
+    {
+        namespace {
+            inline u8 AbsDiff(u8 a, u8 b)
+            {
+                return (a > b) ? (a-b) : (b-a);
+            }
+
+            // * Returns the largest channel difference
+            //   of one pixel
+            inline u8 PixelDiff(u8 const * a, u8 const * b)
+            {
+                return std::max(std::max(AbsDiff(a[0],b[0]),AbsDiff(a[1],b[1])),
+                                std::max(AbsDiff(a[2],b[2]),AbsDiff(a[3],b[3])));
+            }
+
+            // * Compares pixels [@i,@pixels) and adds them
+            //   to @result
+            void CompareRange(u8 const * a,
+                              u8 const * b,
+                              size_t i,
+                              size_t pixels,
+                              u8 tolerance,
+                              ImageDiff::Result &result)
+            {
+                for(; i < pixels; i++) {
+                    u8 const diff = PixelDiff(a+(i*4),b+(i*4));
+                    result.max_difference = std::max(result.max_difference,diff);
+                    if(diff > tolerance) {
+                        result.differing_pixels++;
+                    }
+                }
+            }
+        }
+
+        // ============================================================= //
+
+        ImageDiff::Result ImageDiff::Compare(Image const &expected,
+                                             Image const &actual,
+                                             u8 tolerance)
+        {
+            Result result;
+            result.size_mismatch = false;
+            result.differing_pixels = 0;
+            result.max_difference = 0;
+
+            if(expected.width != actual.width ||
+               expected.height != actual.height)
+            {
+                result.size_mismatch = true;
+                return result;
+            }
+
+            u8 const * a = expected.data.data();
+            u8 const * b = actual.data.data();
+            size_t const pixels = size_t(expected.width)*expected.height;
+
+            // Four pixels at a time
+            size_t const blocks = pixels/4;
+            size_t i = 0;
+
+        #if defined(KS_GUI_IMAGE_DIFF_SSE2)
+            __m128i const tol = _mm_set1_epi8(static_cast<char>(tolerance));
+            __m128i const zero = _mm_setzero_si128();
+            __m128i max_diff = zero;
+
+            // Per lane counts of differing pixels (as negative
+            // numbers since a set mask is -1); flushed before
+            // they can overflow
+            __m128i count = zero;
+            uint count_blocks = 0;
+            u64 differing = 0;
+
+            for(size_t block=0; block < blocks; block++, i += 4)
+            {
+                __m128i const va = _mm_loadu_si128(
+                            reinterpret_cast<__m128i const *>(a+(i*4)));
+                __m128i const vb = _mm_loadu_si128(
+                            reinterpret_cast<__m128i const *>(b+(i*4)));
+
+                __m128i const diff = _mm_or_si128(_mm_subs_epu8(va,vb),
+                                                  _mm_subs_epu8(vb,va));
+
+                max_diff = _mm_max_epu8(max_diff,diff);
+
+                // Non zero channels exceeded the tolerance
+                __m128i const over = _mm_subs_epu8(diff,tol);
+                __m128i const pixel_ok = _mm_cmpeq_epi32(over,zero);
+
+                // andnot gives -1 for differing pixels
+                count = _mm_sub_epi32(count,_mm_andnot_si128(pixel_ok,_mm_set1_epi32(-1)));
+
+                if(++count_blocks == 0x7FFFFFFF) {
+                    u32 list_counts[4];
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(list_counts),count);
+                    differing += u64(list_counts[0])+list_counts[1]+
+                                 list_counts[2]+list_counts[3];
+                    count = zero;
+                    count_blocks = 0;
+                }
+            }
+
+            u32 list_counts[4];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(list_counts),count);
+            differing += u64(list_counts[0])+list_counts[1]+
+                         list_counts[2]+list_counts[3];
+
+            u8 list_max[16];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(list_max),max_diff);
+
+            result.differing_pixels = differing;
+            result.max_difference = *std::max_element(list_max,list_max+16);
+
+        #elif defined(KS_GUI_IMAGE_DIFF_NEON)
+            uint8x16_t const tol = vdupq_n_u8(tolerance);
+            uint8x16_t max_diff = vdupq_n_u8(0);
+            uint32x4_t count = vdupq_n_u32(0);
+            uint count_blocks = 0;
+            u64 differing = 0;
+
+            for(size_t block=0; block < blocks; block++, i += 4)
+            {
+                uint8x16_t const diff = vabdq_u8(vld1q_u8(a+(i*4)),
+                                                 vld1q_u8(b+(i*4)));
+
+                max_diff = vmaxq_u8(max_diff,diff);
+
+                uint32x4_t const over =
+                        vreinterpretq_u32_u8(vcgtq_u8(diff,tol));
+
+                // vtst gives all ones (-1) for differing pixels
+                count = vsubq_u32(count,vtstq_u32(over,over));
+
+                if(++count_blocks == 0x7FFFFFFF) {
+                    u32 list_counts[4];
+                    vst1q_u32(list_counts,count);
+                    differing += u64(list_counts[0])+list_counts[1]+
+                                 list_counts[2]+list_counts[3];
+                    count = vdupq_n_u32(0);
+                    count_blocks = 0;
+                }
+            }
+
+            u32 list_counts[4];
+            vst1q_u32(list_counts,count);
+            differing += u64(list_counts[0])+list_counts[1]+
+                         list_counts[2]+list_counts[3];
+
+            u8 list_max[16];
+            vst1q_u8(list_max,max_diff);
+
+            result.differing_pixels = differing;
+            result.max_difference = *std::max_element(list_max,list_max+16);
+        #else
+            (void)blocks;
+        #endif
+
+            // Scalar for the remaining pixels
+            CompareRange(a,b,i,pixels,tolerance,result);
+
+            return result;
+        }
+
+        ImageDiff::Result ImageDiff::CompareScalar(Image const &expected,
+                                                   Image const &actual,
+                                                   u8 tolerance)
+        {
+            Result result;
+            result.size_mismatch = false;
+            result.differing_pixels = 0;
+            result.max_difference = 0;
+
+            if(expected.width != actual.width ||
+               expected.height != actual.height)
+            {
+                result.size_mismatch = true;
+                return result;
+            }
+
+            CompareRange(expected.data.data(),
+                         actual.data.data(),
+                         0,
+                         size_t(expected.width)*expected.height,
+                         tolerance,
+                         result);
+
+            return result;
+        }
+
+        Image ImageDiff::MakeDiffImage(Image const &expected,
+                                       Image const &actual,
+                                       u8 tolerance)
+        {
+            Image image(expected.width,expected.height);
+
+            if(expected.width != actual.width ||
+               expected.height != actual.height)
+            {
+                return image;
+            }
+
+            size_t const pixels = size_t(expected.width)*expected.height;
+            for(size_t i=0; i < pixels; i++)
+            {
+                u8 const * a = &expected.data[i*4];
+                u8 const * b = &actual.data[i*4];
+                u8* out = &image.data[i*4];
+
+                if(PixelDiff(a,b) > tolerance) {
+                    out[0] = 255;
+                    out[1] = 0;
+                    out[2] = 0;
+                }
+                else {
+                    u8 const gray = static_cast<u8>(
+                                ((uint(a[0])*77)+(uint(a[1])*150)+(uint(a[2])*29)) >> 10);
+                    out[0] = gray;
+                    out[1] = gray;
+                    out[2] = gray;
+                }
+
+                out[3] = 255;
+            }
+
+            return image;
+        }
+
+        // ============================================================= //
+    }
+}
@@ -0,0 +1,72 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_IMAGE_DIFF_HPP
+#define KS_GUI_IMAGE_DIFF_HPP
+
+#include <ks/gui/KsGuiImage.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        // ============================================================= //
+
+        // * Compares images per pixel with a per channel
+        //   tolerance, vectorized with SSE2 or NEON
+        class ImageDiff final
+        {
+        public:
+            struct Result final
+            {
+                // * True if the images have different sizes;
+                //   the other values aren't set
+                bool size_mismatch;
+
+                // * Pixels with any channel differing by more
+                //   than the tolerance
+                u64 differing_pixels;
+
+                // * The largest difference in any channel
+                u8 max_difference;
+            };
+
+            // * Compares @actual to @expected. A pixel differs
+            //   if any channel differs by more than @tolerance.
+            static Result Compare(Image const &expected,
+                                  Image const &actual,
+                                  u8 tolerance);
+
+            // * Same as Compare without SIMD; the reference
+            //   the vectorized paths are checked against
+            static Result CompareScalar(Image const &expected,
+                                        Image const &actual,
+                                        u8 tolerance);
+
+            // * Builds an image of the differences: differing
+            //   pixels are red and the rest show @expected
+            //   as dimmed gray
+            // * The images must be the same size
+            static Image MakeDiffImage(Image const &expected,
+                                       Image const &actual,
+                                       u8 tolerance);
+        };
+
+        // ============================================================= //
+    }
+}
+
+#endif // KS_GUI_IMAGE_DIFF_HPP
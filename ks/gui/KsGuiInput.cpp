@@ -0,0 +1,69 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <ks/gui/KsGuiInput.hpp>
+#include <cstring>
+
+namespace ks
+{
+    namespace gui
+    {
+        // ============================================================= //
+
+        TextInputEvent::TextInputEvent() :
+            m_inline_size(0)
+        {}
+
+        TextInputEvent::TextInputEvent(char const * utf8,
+                                       std::size_t size,
+                                       TimePoint timestamp,
+                                       Id window_id) :
+            timestamp(timestamp),
+            window_id(window_id),
+            m_inline_size(0)
+        {
+            if(size <= InlineCapacity) {
+                std::memcpy(m_inline_data,utf8,size);
+                m_inline_size = static_cast<u8>(size);
+            }
+            else {
+                m_overflow = make_shared<std::string const>(utf8,size);
+            }
+        }
+
+        char const * TextInputEvent::GetData() const
+        {
+            return m_overflow ? m_overflow->data() : m_inline_data;
+        }
+
+        std::size_t TextInputEvent::GetSize() const
+        {
+            return m_overflow ? m_overflow->size() : m_inline_size;
+        }
+
+        bool TextInputEvent::GetOverflowed() const
+        {
+            return (m_overflow != nullptr);
+        }
+
+        std::string TextInputEvent::ToString() const
+        {
+            return std::string(GetData(),GetSize());
+        }
+
+        // ============================================================= //
+    }
+}
@@ -45,6 +45,10 @@ namespace ks
             float x;
             float y;
             TimePoint timestamp;
+
+            // * Id of the Window this event is for, or 0 if
+            //   the platform doesn't know the source window
+            Id window_id{0};
         };
 
         struct TouchEvent
@@ -61,12 +65,16 @@ namespace ks
             float x;
             float y;
             TimePoint timestamp;
+
+            Id window_id{0}; // see MouseEvent::window_id
         };
 
         struct ScrollEvent
         {
             float x;
             float y;
+
+            Id window_id{0}; // see MouseEvent::window_id
         };
 
         struct KeyEvent
@@ -220,6 +228,44 @@ namespace ks
             uint scancode;
             Action action;
             u8 mods;
+
+            Id window_id{0}; // see MouseEvent::window_id
+        };
+
+        // * UTF-8 text input (ie. typed characters or
+        //   committed IME text)
+        // * Text up to InlineCapacity bytes is stored in the
+        //   event itself so creating and copying the event
+        //   doesn't allocate. Longer text (ie. large IME
+        //   compositions or pastes) is stored in a shared,
+        //   immutable heap string instead.
+        struct TextInputEvent
+        {
+            static uint const InlineCapacity = 47;
+
+            TextInputEvent();
+
+            TextInputEvent(char const * utf8,
+                           std::size_t size,
+                           TimePoint timestamp,
+                           Id window_id=0);
+
+            // * Not null terminated
+            char const * GetData() const;
+            std::size_t GetSize() const;
+
+            // * True if the text didn't fit inline
+            bool GetOverflowed() const;
+
+            std::string ToString() const;
+
+            TimePoint timestamp;
+            Id window_id{0}; // see MouseEvent::window_id
+
+        private:
+            u8 m_inline_size;
+            char m_inline_data[InlineCapacity];
+            shared_ptr<std::string const> m_overflow;
         };
     }
 }
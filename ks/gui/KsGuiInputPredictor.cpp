@@ -0,0 +1,382 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <ks/gui/KsGuiInputPredictor.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        namespace {
+            float GetSeconds(TimePoint::duration const &duration)
+            {
+                return std::chrono::duration<float>(duration).count();
+            }
+
+            InputPredictor::FilterFactory GetFilterFactory(
+                    InputPredictor::Filter filter)
+            {
+                if(filter == InputPredictor::Filter::Quadratic) {
+                    return [](){
+                        return unique_ptr<IPointerFilter>(
+                                    new QuadraticPointerFilter());
+                    };
+                }
+                else if(filter == InputPredictor::Filter::Kalman) {
+                    return [](){
+                        return unique_ptr<IPointerFilter>(
+                                    new KalmanPointerFilter());
+                    };
+                }
+
+                return [](){
+                    return unique_ptr<IPointerFilter>(
+                                new LinearPointerFilter());
+                };
+            }
+        }
+
+        // ============================================================= //
+
+        LinearPointerFilter::LinearPointerFilter() :
+            m_count(0)
+        {}
+
+        void LinearPointerFilter::Reset()
+        {
+            m_count = 0;
+        }
+
+        void LinearPointerFilter::AddSample(float x, float y, TimePoint timestamp)
+        {
+            // Samples with the same timestamp replace the newest
+            if(m_count > 0 && timestamp <= m_timestamp[1]) {
+                m_x[1] = x;
+                m_y[1] = y;
+                return;
+            }
+
+            m_x[0] = m_x[1];
+            m_y[0] = m_y[1];
+            m_timestamp[0] = m_timestamp[1];
+
+            m_x[1] = x;
+            m_y[1] = y;
+            m_timestamp[1] = timestamp;
+
+            if(m_count < 2) {
+                m_count++;
+            }
+        }
+
+        bool LinearPointerFilter::Predict(TimePoint time, float &x, float &y) const
+        {
+            if(m_count == 0) {
+                return false;
+            }
+
+            x = m_x[1];
+            y = m_y[1];
+
+            if(m_count < 2) {
+                return true;
+            }
+
+            float const dt_samples = GetSeconds(m_timestamp[1]-m_timestamp[0]);
+            float const dt = GetSeconds(time-m_timestamp[1]);
+
+            x += (m_x[1]-m_x[0])/dt_samples*dt;
+            y += (m_y[1]-m_y[0])/dt_samples*dt;
+
+            return true;
+        }
+
+        // ============================================================= //
+
+        QuadraticPointerFilter::QuadraticPointerFilter() :
+            m_count(0)
+        {}
+
+        void QuadraticPointerFilter::Reset()
+        {
+            m_count = 0;
+        }
+
+        void QuadraticPointerFilter::AddSample(float x, float y, TimePoint timestamp)
+        {
+            if(m_count > 0 && timestamp <= m_timestamp[2]) {
+                m_x[2] = x;
+                m_y[2] = y;
+                return;
+            }
+
+            for(uint i=0; i < 2; i++) {
+                m_x[i] = m_x[i+1];
+                m_y[i] = m_y[i+1];
+                m_timestamp[i] = m_timestamp[i+1];
+            }
+
+            m_x[2] = x;
+            m_y[2] = y;
+            m_timestamp[2] = timestamp;
+
+            if(m_count < 3) {
+                m_count++;
+            }
+        }
+
+        bool QuadraticPointerFilter::Predict(TimePoint time, float &x, float &y) const
+        {
+            if(m_count == 0) {
+                return false;
+            }
+
+            if(m_count < 3)
+            {
+                // Not enough samples for a parabola yet
+                // so fall back to linear extrapolation
+                x = m_x[2];
+                y = m_y[2];
+
+                if(m_count == 2) {
+                    float const dt_samples = GetSeconds(m_timestamp[2]-m_timestamp[1]);
+                    float const dt = GetSeconds(time-m_timestamp[2]);
+                    x += (m_x[2]-m_x[1])/dt_samples*dt;
+                    y += (m_y[2]-m_y[1])/dt_samples*dt;
+                }
+
+                return true;
+            }
+
+            // Lagrange interpolation with times relative
+            // to the newest sample
+            float const t0 = GetSeconds(m_timestamp[0]-m_timestamp[2]);
+            float const t1 = GetSeconds(m_timestamp[1]-m_timestamp[2]);
+            float const t2 = 0.0f;
+            float const t = GetSeconds(time-m_timestamp[2]);
+
+            float const l0 = ((t-t1)*(t-t2))/((t0-t1)*(t0-t2));
+            float const l1 = ((t-t0)*(t-t2))/((t1-t0)*(t1-t2));
+            float const l2 = ((t-t0)*(t-t1))/((t2-t0)*(t2-t1));
+
+            x = l0*m_x[0] + l1*m_x[1] + l2*m_x[2];
+            y = l0*m_y[0] + l1*m_y[1] + l2*m_y[2];
+
+            return true;
+        }
+
+        // ============================================================= //
+
+        KalmanPointerFilter::KalmanPointerFilter(float process_noise,
+                                                 float measurement_noise) :
+            m_process_noise(process_noise),
+            m_measurement_noise(measurement_noise),
+            m_init(false)
+        {}
+
+        void KalmanPointerFilter::Reset()
+        {
+            m_init = false;
+        }
+
+        void KalmanPointerFilter::AddSample(float x, float y, TimePoint timestamp)
+        {
+            if(!m_init) {
+                initAxis(m_x,x);
+                initAxis(m_y,y);
+                m_timestamp = timestamp;
+                m_init = true;
+                return;
+            }
+
+            float const dt = GetSeconds(timestamp-m_timestamp);
+            if(dt > 0.0f) {
+                m_timestamp = timestamp;
+            }
+
+            updateAxis(m_x,x,dt > 0.0f ? dt : 0.0f);
+            updateAxis(m_y,y,dt > 0.0f ? dt : 0.0f);
+        }
+
+        bool KalmanPointerFilter::Predict(TimePoint time, float &x, float &y) const
+        {
+            if(!m_init) {
+                return false;
+            }
+
+            float const dt = GetSeconds(time-m_timestamp);
+            x = m_x.p + m_x.v*dt;
+            y = m_y.p + m_y.v*dt;
+
+            return true;
+        }
+
+        void KalmanPointerFilter::initAxis(Axis &axis, float p)
+        {
+            // Start with an unknown velocity
+            axis.p = p;
+            axis.v = 0.0f;
+            axis.c00 = m_measurement_noise;
+            axis.c01 = 0.0f;
+            axis.c11 = 1E6f;
+        }
+
+        void KalmanPointerFilter::updateAxis(Axis &axis, float p, float dt)
+        {
+            // Predict
+            float const dt2 = dt*dt;
+            float const q = m_process_noise;
+
+            axis.p += axis.v*dt;
+
+            float const c00 = axis.c00 + 2.0f*dt*axis.c01 + dt2*axis.c11 + q*dt2*dt2*0.25f;
+            float const c01 = axis.c01 + dt*axis.c11 + q*dt2*dt*0.5f;
+            float const c11 = axis.c11 + q*dt2;
+
+            // Update
+            float const s = c00 + m_measurement_noise;
+            float const k0 = c00/s;
+            float const k1 = c01/s;
+            float const residual = p - axis.p;
+
+            axis.p += k0*residual;
+            axis.v += k1*residual;
+
+            axis.c00 = (1.0f-k0)*c00;
+            axis.c01 = (1.0f-k0)*c01;
+            axis.c11 = c11 - k1*c01;
+        }
+
+        // ============================================================= //
+
+        InputPredictor::InputPredictor() :
+            m_max_prediction(50),
+            m_mouse_valid(false)
+        {
+            for(uint i=0; i < MaxTouches; i++) {
+                m_list_touch_active[i] = false;
+            }
+
+            SetFilter(Filter::Linear);
+        }
+
+        void InputPredictor::SetFilter(Filter filter)
+        {
+            SetFilter(GetFilterFactory(filter));
+        }
+
+        void InputPredictor::SetFilter(FilterFactory factory)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            m_mouse_filter = factory();
+            m_mouse_valid = false;
+
+            for(uint i=0; i < MaxTouches; i++) {
+                m_list_touch_filters[i] = factory();
+                m_list_touch_active[i] = false;
+            }
+        }
+
+        void InputPredictor::SetMaxPrediction(Milliseconds max_prediction)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_max_prediction = max_prediction;
+        }
+
+        void InputPredictor::ProcessMouseEvent(MouseEvent const &event)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            m_mouse_filter->AddSample(event.x,event.y,event.timestamp);
+            m_mouse_timestamp = event.timestamp;
+            m_mouse_valid = true;
+        }
+
+        void InputPredictor::ProcessTouchEvent(TouchEvent const &event)
+        {
+            if(event.index >= MaxTouches) {
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            IPointerFilter &filter = *(m_list_touch_filters[event.index]);
+
+            if(event.action == TouchEvent::Action::Press) {
+                filter.Reset();
+                m_list_touch_active[event.index] = true;
+            }
+            else if(event.action == TouchEvent::Action::Release) {
+                m_list_touch_active[event.index] = false;
+                return;
+            }
+            else if(!m_list_touch_active[event.index]) {
+                return;
+            }
+
+            filter.AddSample(event.x,event.y,event.timestamp);
+            m_list_touch_timestamp[event.index] = event.timestamp;
+        }
+
+        bool InputPredictor::PredictMouse(TimePoint time, float &x, float &y) const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if(!m_mouse_valid) {
+                return false;
+            }
+
+            return predict(*m_mouse_filter,m_mouse_timestamp,time,x,y);
+        }
+
+        bool InputPredictor::PredictTouch(u8 index, TimePoint time, float &x, float &y) const
+        {
+            if(index >= MaxTouches) {
+                return false;
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if(!m_list_touch_active[index]) {
+                return false;
+            }
+
+            return predict(*(m_list_touch_filters[index]),
+                           m_list_touch_timestamp[index],
+                           time,x,y);
+        }
+
+        bool InputPredictor::predict(IPointerFilter const &filter,
+                                     TimePoint latest,
+                                     TimePoint time,
+                                     float &x, float &y) const
+        {
+            // Don't predict into the past or too far into
+            // the future where the error grows quickly
+            if(time < latest) {
+                time = latest;
+            }
+            else if(time > latest+m_max_prediction) {
+                time = latest+m_max_prediction;
+            }
+
+            return filter.Predict(time,x,y);
+        }
+
+        // ============================================================= //
+    }
+}
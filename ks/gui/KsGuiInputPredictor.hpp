@@ -0,0 +1,194 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_INPUT_PREDICTOR_HPP
+#define KS_GUI_INPUT_PREDICTOR_HPP
+
+#include <mutex>
+#include <functional>
+#include <ks/gui/KsGuiInput.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        // ============================================================= //
+
+        // * Estimates the position of a single pointer at
+        //   some time from its recent positions
+        class IPointerFilter
+        {
+        public:
+            virtual ~IPointerFilter() = default;
+
+            virtual void Reset() = 0;
+
+            // * Samples are added in timestamp order
+            virtual void AddSample(float x, float y, TimePoint timestamp) = 0;
+
+            // * Returns false if there isn't any history yet
+            virtual bool Predict(TimePoint time, float &x, float &y) const = 0;
+        };
+
+        // ============================================================= //
+
+        // * Extrapolates using the velocity between the
+        //   last two samples
+        class LinearPointerFilter final : public IPointerFilter
+        {
+        public:
+            LinearPointerFilter();
+            ~LinearPointerFilter() = default;
+
+            void Reset() override;
+            void AddSample(float x, float y, TimePoint timestamp) override;
+            bool Predict(TimePoint time, float &x, float &y) const override;
+
+        private:
+            uint m_count;
+            float m_x[2];
+            float m_y[2];
+            TimePoint m_timestamp[2];
+        };
+
+        // ============================================================= //
+
+        // * Extrapolates along the parabola through the
+        //   last three samples
+        class QuadraticPointerFilter final : public IPointerFilter
+        {
+        public:
+            QuadraticPointerFilter();
+            ~QuadraticPointerFilter() = default;
+
+            void Reset() override;
+            void AddSample(float x, float y, TimePoint timestamp) override;
+            bool Predict(TimePoint time, float &x, float &y) const override;
+
+        private:
+            uint m_count;
+            float m_x[3];
+            float m_y[3];
+            TimePoint m_timestamp[3];
+        };
+
+        // ============================================================= //
+
+        // * Constant velocity Kalman filter for each axis
+        // * Smooths out jitter in the samples at the cost
+        //   of reacting slower to sudden changes
+        class KalmanPointerFilter final : public IPointerFilter
+        {
+        public:
+            /// \param process_noise
+            ///     Acceleration variance of the model in units/s^2.
+            ///     Higher values follow changes in direction faster.
+            /// \param measurement_noise
+            ///     Variance of the sampled positions in units^2
+            KalmanPointerFilter(float process_noise=2000.0f,
+                                float measurement_noise=1.0f);
+
+            ~KalmanPointerFilter() = default;
+
+            void Reset() override;
+            void AddSample(float x, float y, TimePoint timestamp) override;
+            bool Predict(TimePoint time, float &x, float &y) const override;
+
+        private:
+            struct Axis
+            {
+                float p; // position
+                float v; // velocity
+                float c00,c01,c11; // covariance
+            };
+
+            void initAxis(Axis &axis, float p);
+            void updateAxis(Axis &axis, float p, float dt);
+
+            float const m_process_noise;
+            float const m_measurement_noise;
+
+            bool m_init;
+            Axis m_x;
+            Axis m_y;
+            TimePoint m_timestamp;
+        };
+
+        // ============================================================= //
+
+        // * Tracks the mouse pointer and touch fingers and
+        //   predicts their positions at a future time, such
+        //   as the presentation time of the next frame
+        // * All methods are thread safe
+        class InputPredictor final
+        {
+        public:
+            enum class Filter
+            {
+                Linear,
+                Quadratic,
+                Kalman
+            };
+
+            using FilterFactory = std::function<unique_ptr<IPointerFilter>()>;
+
+            // * Fingers with an index >= MaxTouches are ignored
+            static uint const MaxTouches = 10;
+
+            InputPredictor();
+            ~InputPredictor() = default;
+
+            // * Replaces the filter for the mouse and all
+            //   fingers, clearing their history
+            void SetFilter(Filter filter);
+            void SetFilter(FilterFactory factory);
+
+            // * Predictions are never extrapolated further
+            //   than @max_prediction past the newest sample
+            void SetMaxPrediction(Milliseconds max_prediction);
+
+            void ProcessMouseEvent(MouseEvent const &event);
+            void ProcessTouchEvent(TouchEvent const &event);
+
+            // * Return false if there's nothing to predict
+            //   from (ie. the finger isn't down)
+            bool PredictMouse(TimePoint time, float &x, float &y) const;
+            bool PredictTouch(u8 index, TimePoint time, float &x, float &y) const;
+
+        private:
+            bool predict(IPointerFilter const &filter,
+                         TimePoint latest,
+                         TimePoint time,
+                         float &x, float &y) const;
+
+            mutable std::mutex m_mutex;
+
+            Milliseconds m_max_prediction;
+
+            unique_ptr<IPointerFilter> m_mouse_filter;
+            bool m_mouse_valid;
+            TimePoint m_mouse_timestamp;
+
+            unique_ptr<IPointerFilter> m_list_touch_filters[MaxTouches];
+            bool m_list_touch_active[MaxTouches];
+            TimePoint m_list_touch_timestamp[MaxTouches];
+        };
+
+        // ============================================================= //
+    }
+}
+
+#endif // KS_GUI_INPUT_PREDICTOR_HPP
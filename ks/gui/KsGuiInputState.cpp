@@ -0,0 +1,164 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <ks/gui/KsGuiInputState.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        namespace {
+            uint GetKeyIndex(KeyEvent::Key key)
+            {
+                return static_cast<uint>(key);
+            }
+
+            struct ModifierKeys
+            {
+                u8 bit;
+                KeyEvent::Key left;
+                KeyEvent::Key right;
+            };
+
+            ModifierKeys const g_list_modifier_keys[] = {
+                { KeyEvent::MOD_CTRL,
+                  KeyEvent::Key::KEY_LEFT_CONTROL,
+                  KeyEvent::Key::KEY_RIGHT_CONTROL },
+                { KeyEvent::MOD_SHIFT,
+                  KeyEvent::Key::KEY_LEFT_SHIFT,
+                  KeyEvent::Key::KEY_RIGHT_SHIFT },
+                { KeyEvent::MOD_ALT,
+                  KeyEvent::Key::KEY_LEFT_ALT,
+                  KeyEvent::Key::KEY_RIGHT_ALT },
+                { KeyEvent::MOD_SUPER,
+                  KeyEvent::Key::KEY_LEFT_SUPER,
+                  KeyEvent::Key::KEY_RIGHT_SUPER }
+            };
+        }
+
+        // ============================================================= //
+
+        InputState::InputState() :
+            m_mouse_buttons(0),
+            m_mods(KeyEvent::MOD_NONE)
+        {
+            for(auto& word : m_list_keys) {
+                word.store(0,std::memory_order_relaxed);
+            }
+        }
+
+        bool InputState::GetKeyDown(KeyEvent::Key key) const
+        {
+            return getKey(GetKeyIndex(key));
+        }
+
+        u8 InputState::GetMouseButtons() const
+        {
+            return m_mouse_buttons.load(std::memory_order_relaxed);
+        }
+
+        bool InputState::GetMouseButtonDown(MouseEvent::Button button) const
+        {
+            return ((GetMouseButtons() & static_cast<u8>(button)) != 0);
+        }
+
+        u8 InputState::GetMods() const
+        {
+            return m_mods.load(std::memory_order_relaxed);
+        }
+
+        void InputState::ProcessKeyEvent(KeyEvent const &event)
+        {
+            bool const down = (event.action != KeyEvent::Action::Release);
+            setKey(GetKeyIndex(event.key),down);
+
+            // Some platforms report the modifiers as they were
+            // before this event, so the modifier of a modifier
+            // key event comes from the key state instead: it's
+            // set while either its left or right key is down
+            u8 mods = event.mods;
+
+            for(auto const &modifier : g_list_modifier_keys)
+            {
+                if(event.key != modifier.left && event.key != modifier.right) {
+                    continue;
+                }
+
+                if(getKey(GetKeyIndex(modifier.left)) ||
+                   getKey(GetKeyIndex(modifier.right)))
+                {
+                    mods |= modifier.bit;
+                }
+                else {
+                    mods &= static_cast<u8>(~modifier.bit);
+                }
+            }
+
+            m_mods.store(mods,std::memory_order_relaxed);
+        }
+
+        void InputState::ProcessMouseEvent(MouseEvent const &event)
+        {
+            u8 const button = static_cast<u8>(event.button);
+
+            if(event.action == MouseEvent::Action::Press) {
+                m_mouse_buttons.fetch_or(button,std::memory_order_relaxed);
+            }
+            else if(event.action == MouseEvent::Action::Release) {
+                m_mouse_buttons.fetch_and(static_cast<u8>(~button),std::memory_order_relaxed);
+            }
+        }
+
+        void InputState::Clear()
+        {
+            for(auto& word : m_list_keys) {
+                word.store(0,std::memory_order_relaxed);
+            }
+
+            m_mouse_buttons.store(0,std::memory_order_relaxed);
+            m_mods.store(KeyEvent::MOD_NONE,std::memory_order_relaxed);
+        }
+
+        void InputState::setKey(uint key, bool down)
+        {
+            if(key >= KeyCount) {
+                return;
+            }
+
+            u32 const bit = u32(1) << (key%32);
+            std::atomic<u32>& word = m_list_keys[key/32];
+
+            if(down) {
+                word.fetch_or(bit,std::memory_order_relaxed);
+            }
+            else {
+                word.fetch_and(~bit,std::memory_order_relaxed);
+            }
+        }
+
+        bool InputState::getKey(uint key) const
+        {
+            if(key >= KeyCount) {
+                return false;
+            }
+
+            u32 const bit = u32(1) << (key%32);
+            return ((m_list_keys[key/32].load(std::memory_order_relaxed) & bit) != 0);
+        }
+
+        // ============================================================= //
+    }
+}
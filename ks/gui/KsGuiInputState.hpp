@@ -0,0 +1,77 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_INPUT_STATE_HPP
+#define KS_GUI_INPUT_STATE_HPP
+
+#include <ks/gui/KsGuiInput.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        // ============================================================= //
+
+        // * The current state of every key, mouse button
+        //   and keyboard modifier
+        // * The Get methods are wait-free and can be called
+        //   from any thread (ie. to move a camera while a key
+        //   is held from within a render loop)
+        // * The Process methods must only be called from
+        //   a single thread
+        class InputState final
+        {
+        public:
+            // * Keys with a larger value are ignored
+            static uint const KeyCount =
+                    static_cast<uint>(KeyEvent::Key::KEY_MENU)+1;
+
+            InputState();
+            ~InputState() = default;
+
+            bool GetKeyDown(KeyEvent::Key key) const;
+
+            // * Returns a mask of MouseEvent::Button values
+            u8 GetMouseButtons() const;
+            bool GetMouseButtonDown(MouseEvent::Button button) const;
+
+            // * Returns a mask of KeyEvent::MOD_ values
+            u8 GetMods() const;
+
+            void ProcessKeyEvent(KeyEvent const &event);
+            void ProcessMouseEvent(MouseEvent const &event);
+
+            // * Releases all keys and buttons (ie. when
+            //   focus is lost and release events won't
+            //   be received)
+            void Clear();
+
+        private:
+            static uint const WordCount = (KeyCount+31)/32;
+
+            void setKey(uint key, bool down);
+            bool getKey(uint key) const;
+
+            std::atomic<u32> m_list_keys[WordCount];
+            std::atomic<u8> m_mouse_buttons;
+            std::atomic<u8> m_mods;
+        };
+
+        // ============================================================= //
+    }
+}
+
+#endif // KS_GUI_INPUT_STATE_HPP
@@ -0,0 +1,189 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <ks/gui/KsGuiInputTransform.hpp>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #include <xmmintrin.h>
+    #define KS_GUI_INPUT_TRANSFORM_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define KS_GUI_INPUT_TRANSFORM_NEON 1
+#endif
+
+namespace ks
+{
+    namespace gui
+    {
+        namespace {
+            float GetDpiScale(float dpi)
+            {
+                // Some platforms don't report a density
+                if(!(dpi > 0.0f)) {
+                    return 1.0f;
+                }
+                return InputTransform::ReferenceDpi/dpi;
+            }
+        }
+
+        // ============================================================= //
+
+        #if defined(KS_ENV_ANDROID)
+            float const InputTransform::ReferenceDpi = 160.0f;
+        #else
+            float const InputTransform::ReferenceDpi = 96.0f;
+        #endif
+
+        InputTransform::InputTransform() :
+            m_a(1.0f),
+            m_b(0.0f),
+            m_c(0.0f),
+            m_d(1.0f),
+            m_tx(0.0f),
+            m_ty(0.0f)
+        {}
+
+        InputTransform InputTransform::Create(Screen const &screen,
+                                              Window::Position const &win_position)
+        {
+            return Create(screen.rotation.Get(),
+                          screen.size_px.Get(),
+                          screen.xdpi.Get(),
+                          screen.ydpi.Get(),
+                          win_position);
+        }
+
+        InputTransform InputTransform::Create(Screen::Rotation rotation,
+                                              Screen::Size const &size_px,
+                                              float xdpi,
+                                              float ydpi,
+                                              Window::Position const &win_position)
+        {
+            // The native coordinate (x,y) is first rotated into
+            // screen space, then offset by the window position
+            // and finally scaled to logical units:
+            // x' = sx*(rx(x,y)-px), y' = sy*(ry(x,y)-py)
+            float const w = static_cast<float>(size_px.first);
+            float const h = static_cast<float>(size_px.second);
+            float const px = static_cast<float>(win_position.first);
+            float const py = static_cast<float>(win_position.second);
+
+            InputTransform xf;
+
+            if(rotation == Screen::Rotation::CW_0)
+            {
+                // rx = x, ry = y
+                float const sx = GetDpiScale(xdpi);
+                float const sy = GetDpiScale(ydpi);
+                xf.m_a = sx;    xf.m_b = 0.0f;  xf.m_tx = -sx*px;
+                xf.m_c = 0.0f;  xf.m_d = sy;    xf.m_ty = -sy*py;
+            }
+            else if(rotation == Screen::Rotation::CW_90)
+            {
+                // rx = y, ry = w-x
+                float const sx = GetDpiScale(ydpi);
+                float const sy = GetDpiScale(xdpi);
+                xf.m_a = 0.0f;  xf.m_b = sx;    xf.m_tx = -sx*px;
+                xf.m_c = -sy;   xf.m_d = 0.0f;  xf.m_ty = sy*(w-py);
+            }
+            else if(rotation == Screen::Rotation::CW_180)
+            {
+                // rx = w-x, ry = h-y
+                float const sx = GetDpiScale(xdpi);
+                float const sy = GetDpiScale(ydpi);
+                xf.m_a = -sx;   xf.m_b = 0.0f;  xf.m_tx = sx*(w-px);
+                xf.m_c = 0.0f;  xf.m_d = -sy;   xf.m_ty = sy*(h-py);
+            }
+            else
+            {
+                // rx = h-y, ry = x
+                float const sx = GetDpiScale(ydpi);
+                float const sy = GetDpiScale(xdpi);
+                xf.m_a = 0.0f;  xf.m_b = -sx;   xf.m_tx = sx*(h-px);
+                xf.m_c = sy;    xf.m_d = 0.0f;  xf.m_ty = -sy*py;
+            }
+
+            return xf;
+        }
+
+        void InputTransform::Apply(float &x, float &y) const
+        {
+            float const nx = m_a*x + m_b*y + m_tx;
+            float const ny = m_c*x + m_d*y + m_ty;
+            x = nx;
+            y = ny;
+        }
+
+        void InputTransform::Apply(float* list_x,
+                                   float* list_y,
+                                   std::size_t count) const
+        {
+            std::size_t i=0;
+
+        #if defined(KS_GUI_INPUT_TRANSFORM_SSE)
+            __m128 const a = _mm_set1_ps(m_a);
+            __m128 const b = _mm_set1_ps(m_b);
+            __m128 const c = _mm_set1_ps(m_c);
+            __m128 const d = _mm_set1_ps(m_d);
+            __m128 const tx = _mm_set1_ps(m_tx);
+            __m128 const ty = _mm_set1_ps(m_ty);
+
+            for(; i+4 <= count; i+=4)
+            {
+                __m128 const x = _mm_loadu_ps(list_x+i);
+                __m128 const y = _mm_loadu_ps(list_y+i);
+
+                __m128 const nx =
+                        _mm_add_ps(
+                            _mm_add_ps(_mm_mul_ps(a,x),_mm_mul_ps(b,y)),tx);
+
+                __m128 const ny =
+                        _mm_add_ps(
+                            _mm_add_ps(_mm_mul_ps(c,x),_mm_mul_ps(d,y)),ty);
+
+                _mm_storeu_ps(list_x+i,nx);
+                _mm_storeu_ps(list_y+i,ny);
+            }
+        #elif defined(KS_GUI_INPUT_TRANSFORM_NEON)
+            float32x4_t const tx = vdupq_n_f32(m_tx);
+            float32x4_t const ty = vdupq_n_f32(m_ty);
+
+            for(; i+4 <= count; i+=4)
+            {
+                float32x4_t const x = vld1q_f32(list_x+i);
+                float32x4_t const y = vld1q_f32(list_y+i);
+
+                float32x4_t nx = vmlaq_n_f32(tx,x,m_a);
+                nx = vmlaq_n_f32(nx,y,m_b);
+
+                float32x4_t ny = vmlaq_n_f32(ty,x,m_c);
+                ny = vmlaq_n_f32(ny,y,m_d);
+
+                vst1q_f32(list_x+i,nx);
+                vst1q_f32(list_y+i,ny);
+            }
+        #endif
+
+            // Remainder (or everything without SIMD)
+            for(; i < count; i++)
+            {
+                Apply(list_x[i],list_y[i]);
+            }
+        }
+
+        // ============================================================= //
+    }
+}
@@ -0,0 +1,81 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_INPUT_TRANSFORM_HPP
+#define KS_GUI_INPUT_TRANSFORM_HPP
+
+#include <ks/gui/KsGuiScreen.hpp>
+#include <ks/gui/KsGuiWindow.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        // ============================================================= //
+
+        // * Affine transform that maps raw platform input
+        //   coordinates to logical window units
+        // * Platform coordinates are expected in pixels relative
+        //   to the origin of the unrotated (native) screen
+        // * Logical units are pixels at ReferenceDpi, relative
+        //   to the top left corner of the window
+        class InputTransform final
+        {
+        public:
+            // * The density that one logical unit corresponds to
+            static float const ReferenceDpi;
+
+            // * Creates an identity transform
+            InputTransform();
+
+            /// * Creates the transform for a window on @screen
+            /// \param screen
+            ///     The screen the window is on. Screen::size_px is
+            ///     taken to be the native (unrotated) size and
+            ///     xdpi/ydpi are taken along the native axes.
+            /// \param win_position
+            ///     The window position in rotated screen pixels
+            static InputTransform Create(Screen const &screen,
+                                         Window::Position const &win_position);
+
+            static InputTransform Create(Screen::Rotation rotation,
+                                         Screen::Size const &size_px,
+                                         float xdpi,
+                                         float ydpi,
+                                         Window::Position const &win_position);
+
+            void Apply(float &x, float &y) const;
+
+            // * Transforms @count coordinates in place
+            // * Uses SSE or NEON when available
+            void Apply(float* list_x, float* list_y, std::size_t count) const;
+
+        private:
+            // x' = m_a*x + m_b*y + m_tx
+            // y' = m_c*x + m_d*y + m_ty
+            float m_a;
+            float m_b;
+            float m_c;
+            float m_d;
+            float m_tx;
+            float m_ty;
+        };
+
+        // ============================================================= //
+    }
+}
+
+#endif // KS_GUI_INPUT_TRANSFORM_HPP
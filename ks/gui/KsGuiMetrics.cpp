@@ -0,0 +1,196 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <ks/gui/KsGuiMetrics.hpp>
+#include <mutex>
+#include <algorithm>
+
+namespace ks
+{
+    namespace gui
+    {
+        namespace {
+            struct Registry
+            {
+                Registry() :
+                    process_events(0)
+                {
+                    for(auto& count : list_events) {
+                        count.store(0,std::memory_order_relaxed);
+                    }
+                }
+
+                std::atomic<u64> list_events[Metrics::EventTypeCount];
+                std::atomic<u64> process_events;
+
+                // * Only locked when windows are added or
+                //   removed and when taking a snapshot
+                std::mutex mutex;
+                std::vector<shared_ptr<Metrics::WindowCounters>> list_windows;
+            };
+
+            Registry& GetRegistry()
+            {
+                static Registry registry;
+                return registry;
+            }
+
+            char const * const g_list_event_names[Metrics::EventTypeCount] = {
+                "keyboard",
+                "text",
+                "mouse",
+                "touch",
+                "scroll"
+            };
+        }
+
+        // ============================================================= //
+
+        Metrics::WindowCounters::WindowCounters(Id id) :
+            id(id),
+            frames_rendered(0),
+            frames_dropped(0),
+            context_switches(0),
+            pending_input(0)
+        {}
+
+        void Metrics::AddEvents(EventType type, u64 count)
+        {
+            GetRegistry().list_events[static_cast<uint>(type)].fetch_add(
+                        count,std::memory_order_relaxed);
+        }
+
+        void Metrics::AddProcessEvents()
+        {
+            GetRegistry().process_events.fetch_add(
+                        1,std::memory_order_relaxed);
+        }
+
+        shared_ptr<Metrics::WindowCounters> Metrics::RegisterWindow(Id id)
+        {
+            auto counters = make_shared<WindowCounters>(id);
+
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.list_windows.push_back(counters);
+
+            return counters;
+        }
+
+        void Metrics::UnregisterWindow(Id id)
+        {
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+
+            registry.list_windows.erase(
+                        std::remove_if(
+                            registry.list_windows.begin(),
+                            registry.list_windows.end(),
+                            [id](shared_ptr<WindowCounters> const &counters) {
+                                return (counters->id == id);
+                            }),
+                        registry.list_windows.end());
+        }
+
+        Metrics::Snapshot Metrics::GetSnapshot()
+        {
+            Registry& registry = GetRegistry();
+
+            Snapshot snapshot;
+            snapshot.time = std::chrono::steady_clock::now();
+
+            for(uint i=0; i < EventTypeCount; i++) {
+                snapshot.list_events[i] =
+                        registry.list_events[i].load(std::memory_order_relaxed);
+            }
+
+            snapshot.process_events =
+                    registry.process_events.load(std::memory_order_relaxed);
+
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            snapshot.open_windows = static_cast<uint>(registry.list_windows.size());
+            snapshot.list_windows.reserve(registry.list_windows.size());
+
+            for(auto const &counters : registry.list_windows) {
+                WindowSnapshot window;
+                window.id = counters->id;
+                window.frames_rendered =
+                        counters->frames_rendered.load(std::memory_order_relaxed);
+                window.frames_dropped =
+                        counters->frames_dropped.load(std::memory_order_relaxed);
+                window.context_switches =
+                        counters->context_switches.load(std::memory_order_relaxed);
+                window.pending_input =
+                        counters->pending_input.load(std::memory_order_relaxed);
+
+                snapshot.list_windows.push_back(window);
+            }
+
+            return snapshot;
+        }
+
+        void Metrics::WriteText(std::ostream &stream,
+                                Snapshot const &snapshot,
+                                Snapshot const * previous)
+        {
+            for(uint i=0; i < EventTypeCount; i++) {
+                stream << "ks_gui_events_total{type=\""
+                       << g_list_event_names[i] << "\"} "
+                       << snapshot.list_events[i] << "\n";
+            }
+
+            if(previous)
+            {
+                double const seconds =
+                        std::chrono::duration_cast<
+                            std::chrono::duration<double>>(
+                                snapshot.time-previous->time).count();
+
+                if(seconds > 0.0) {
+                    for(uint i=0; i < EventTypeCount; i++) {
+                        u64 const delta =
+                                snapshot.list_events[i]-
+                                std::min(snapshot.list_events[i],
+                                         previous->list_events[i]);
+
+                        stream << "ks_gui_events_per_second{type=\""
+                               << g_list_event_names[i] << "\"} "
+                               << (delta/seconds) << "\n";
+                    }
+                }
+            }
+
+            stream << "ks_gui_process_events_total "
+                   << snapshot.process_events << "\n";
+
+            stream << "ks_gui_open_windows "
+                   << snapshot.open_windows << "\n";
+
+            for(auto const &window : snapshot.list_windows) {
+                stream << "ks_gui_window_frames_rendered_total{window=\""
+                       << window.id << "\"} " << window.frames_rendered << "\n";
+                stream << "ks_gui_window_frames_dropped_total{window=\""
+                       << window.id << "\"} " << window.frames_dropped << "\n";
+                stream << "ks_gui_window_context_switches_total{window=\""
+                       << window.id << "\"} " << window.context_switches << "\n";
+                stream << "ks_gui_window_pending_input{window=\""
+                       << window.id << "\"} " << window.pending_input << "\n";
+            }
+        }
+
+        // ============================================================= //
+    }
+}
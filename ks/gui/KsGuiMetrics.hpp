@@ -0,0 +1,121 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_METRICS_HPP
+#define KS_GUI_METRICS_HPP
+
+#include <atomic>
+#include <ostream>
+#include <vector>
+#include <ks/KsGlobal.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        // ============================================================= //
+
+        // * Process wide counters and gauges updated by
+        //   Application and Window
+        // * All updates are relaxed atomics so they're cheap
+        //   enough to leave enabled in production
+        // * All methods are thread safe
+        class Metrics final
+        {
+        public:
+            enum class EventType : uint
+            {
+                Keyboard,
+                Text,
+                Mouse,
+                Touch,
+                Scroll
+            };
+
+            static uint const EventTypeCount = 5;
+
+            // * Counters for a single Window, updated directly
+            //   by the Window that owns them
+            struct WindowCounters final
+            {
+                WindowCounters(Id id);
+
+                Id const id;
+
+                // * Frames swapped
+                std::atomic<u64> frames_rendered;
+
+                // * Frames that were requested but not presented
+                //   because rendering was blocked (ie. paused)
+                std::atomic<u64> frames_dropped;
+
+                // * Calls to make the context current
+                std::atomic<u64> context_switches;
+
+                // * Input events queued to the Window's EventLoop
+                //   that it hasn't handled yet. Other tasks
+                //   queued to the EventLoop aren't counted.
+                std::atomic<sint> pending_input;
+            };
+
+            struct WindowSnapshot final
+            {
+                Id id;
+                u64 frames_rendered;
+                u64 frames_dropped;
+                u64 context_switches;
+                sint pending_input;
+            };
+
+            struct Snapshot final
+            {
+                TimePoint time;
+
+                // * Indexed by EventType
+                u64 list_events[EventTypeCount];
+
+                u64 process_events;
+                uint open_windows;
+
+                // * Only open windows are listed
+                std::vector<WindowSnapshot> list_windows;
+            };
+
+            static void AddEvents(EventType type, u64 count=1);
+            static void AddProcessEvents();
+
+            // * Creates the counters for a new Window; they're
+            //   reported until UnregisterWindow is called
+            static shared_ptr<WindowCounters> RegisterWindow(Id id);
+            static void UnregisterWindow(Id id);
+
+            // * Reads the current values
+            static Snapshot GetSnapshot();
+
+            // * Writes @snapshot as one "name{labels} value" line
+            //   per metric (the Prometheus text format)
+            // * If @previous is given, per second event rates
+            //   since @previous are written as well
+            static void WriteText(std::ostream &stream,
+                                  Snapshot const &snapshot,
+                                  Snapshot const * previous=nullptr);
+        };
+
+        // ============================================================= //
+    }
+}
+
+#endif // KS_GUI_METRICS_HPP
@@ -15,6 +15,7 @@
 */
 
 #include <ks/gui/KsGuiPlatform.hpp>
+#include <algorithm>
 
 namespace ks
 {
@@ -35,5 +36,240 @@ namespace ks
         WindowContextMakeCurrentError::WindowContextMakeCurrentError(std::string msg) :
             ks::Exception(ks::Exception::ErrorLevel::FATAL,std::move(msg),true)
         {}
+
+        // ============================================================= //
+
+        IPlatformWindow::IPlatformWindow() :
+            m_window_id(0)
+        {
+            // Deprecated direct emits go through the Notify methods
+            signal_size_changed.m_notify =
+                    [this](Window::Size size) { NotifySizeChanged(size); };
+            signal_position_changed.m_notify =
+                    [this](Window::Position position) { NotifyPositionChanged(position); };
+            signal_fullscreen_changed.m_notify =
+                    [this](Window::FullscreenMode fullscreen) { NotifyFullscreenChanged(fullscreen); };
+            signal_focused_changed.m_notify =
+                    [this](bool focused) { NotifyFocusedChanged(focused); };
+            signal_visible_changed.m_notify =
+                    [this](bool visible) { NotifyVisibleChanged(visible); };
+            signal_always_on_top_changed.m_notify =
+                    [this](bool always_on_top) { NotifyAlwaysOnTopChanged(always_on_top); };
+            signal_swap_interval_changed.m_notify =
+                    [this](uint swap_interval) { NotifySwapIntervalChanged(swap_interval); };
+            signal_title_changed.m_notify =
+                    [this](std::string title) { NotifyTitleChanged(title); };
+            signal_close.m_notify =
+                    [this]() { NotifyClose(); };
+        }
+
+        void IPlatformWindow::SetWindowId(Id window_id)
+        {
+            m_window_id = window_id;
+        }
+
+        Id IPlatformWindow::GetWindowId() const
+        {
+            return m_window_id;
+        }
+
+        void IPlatformWindow::SetContextSwapInterval(uint)
+        {
+            // Platforms that can't change the interval
+            // per swap present each window at its own
+            // swap_interval
+        }
+
+        bool IPlatformWindow::GetHasContextSwapInterval() const
+        {
+            return false;
+        }
+
+        bool IPlatformWindow::GetHasGLContext() const
+        {
+            return true;
+        }
+
+        void IPlatformWindow::ApplyProperties(Window::PropertyChanges const &changes)
+        {
+            using Changes = Window::PropertyChanges;
+
+            // Fullscreen first so that size and position
+            // apply to the resulting windowed state
+            if(changes.GetHas(Changes::FULLSCREEN)) {
+                SetFullscreen(changes.fullscreen);
+            }
+            if(changes.GetHas(Changes::SIZE)) {
+                SetSize(changes.size);
+            }
+            if(changes.GetHas(Changes::POSITION)) {
+                SetPosition(changes.position);
+            }
+            if(changes.GetHas(Changes::ALWAYS_ON_TOP)) {
+                SetAlwaysOnTop(changes.always_on_top);
+            }
+            if(changes.GetHas(Changes::SWAP_INTERVAL)) {
+                SetSwapInterval(changes.swap_interval);
+            }
+            if(changes.GetHas(Changes::TITLE)) {
+                SetTitle(changes.title);
+            }
+            if(changes.GetHas(Changes::VISIBLE)) {
+                SetVisible(changes.visible);
+            }
+            if(changes.GetHas(Changes::FOCUSED)) {
+                SetFocused(changes.focused);
+            }
+        }
+
+        void IPlatformWindow::NotifySizeChanged(Window::Size const &size)
+        {
+            WindowNotification notification{};
+            notification.type = WindowNotification::Type::SizeChanged;
+            notification.size = size;
+            m_notify_channel.Push(std::move(notification));
+
+            signal_size_changed.emitSignal(size);
+        }
+
+        void IPlatformWindow::NotifyPositionChanged(Window::Position const &position)
+        {
+            WindowNotification notification{};
+            notification.type = WindowNotification::Type::PositionChanged;
+            notification.position = position;
+            m_notify_channel.Push(std::move(notification));
+
+            signal_position_changed.emitSignal(position);
+        }
+
+        void IPlatformWindow::NotifyFullscreenChanged(Window::FullscreenMode fullscreen)
+        {
+            WindowNotification notification{};
+            notification.type = WindowNotification::Type::FullscreenChanged;
+            notification.fullscreen = fullscreen;
+            m_notify_channel.Push(std::move(notification));
+
+            signal_fullscreen_changed.emitSignal(fullscreen);
+        }
+
+        void IPlatformWindow::NotifyFocusedChanged(bool focused)
+        {
+            WindowNotification notification{};
+            notification.type = WindowNotification::Type::FocusedChanged;
+            notification.flag = focused;
+            m_notify_channel.Push(std::move(notification));
+
+            signal_focused_changed.emitSignal(focused);
+        }
+
+        void IPlatformWindow::NotifyVisibleChanged(bool visible)
+        {
+            WindowNotification notification{};
+            notification.type = WindowNotification::Type::VisibleChanged;
+            notification.flag = visible;
+            m_notify_channel.Push(std::move(notification));
+
+            signal_visible_changed.emitSignal(visible);
+        }
+
+        void IPlatformWindow::NotifyAlwaysOnTopChanged(bool always_on_top)
+        {
+            WindowNotification notification{};
+            notification.type = WindowNotification::Type::AlwaysOnTopChanged;
+            notification.flag = always_on_top;
+            m_notify_channel.Push(std::move(notification));
+
+            signal_always_on_top_changed.emitSignal(always_on_top);
+        }
+
+        void IPlatformWindow::NotifySwapIntervalChanged(uint swap_interval)
+        {
+            WindowNotification notification{};
+            notification.type = WindowNotification::Type::SwapIntervalChanged;
+            notification.swap_interval = swap_interval;
+            m_notify_channel.Push(std::move(notification));
+
+            signal_swap_interval_changed.emitSignal(swap_interval);
+        }
+
+        void IPlatformWindow::NotifyTitleChanged(std::string const &title)
+        {
+            WindowNotification notification{};
+            notification.type = WindowNotification::Type::TitleChanged;
+            notification.title = title;
+            m_notify_channel.Push(std::move(notification));
+
+            signal_title_changed.emitSignal(title);
+        }
+
+        void IPlatformWindow::NotifyClose()
+        {
+            WindowNotification notification{};
+            notification.type = WindowNotification::Type::Close;
+            m_notify_channel.Push(std::move(notification));
+
+            signal_close.emitSignal();
+        }
+
+        void IPlatformWindow::DrainNotifications(
+                std::vector<WindowNotification> &list_notifications)
+        {
+            m_notify_channel.Drain(list_notifications);
+        }
+
+        // ============================================================= //
+
+        void IPlatform::SetContextConfigCache(shared_ptr<ContextConfigCache> cache)
+        {
+            m_context_config_cache = std::move(cache);
+        }
+
+        shared_ptr<ContextConfigCache> const & IPlatform::GetContextConfigCache() const
+        {
+            return m_context_config_cache;
+        }
+
+        int IPlatform::GetEventFd()
+        {
+            return -1;
+        }
+
+        bool IPlatform::WaitEvents(EventWaiter& waiter,
+                                   Milliseconds timeout)
+        {
+            int const fd = GetEventFd();
+            if(fd >= 0) {
+                return waiter.Wait(timeout,fd);
+            }
+
+            // Without an fd platform events can only be
+            // noticed by checking periodically. A negative
+            // timeout would otherwise wait on @waiter alone.
+            Milliseconds const max_interval(10);
+            if(timeout.count() < 0 || timeout > max_interval) {
+                timeout = max_interval;
+            }
+
+            return waiter.Wait(timeout);
+        }
+
+        void IPlatform::SetEventWaiter(shared_ptr<EventWaiter> waiter)
+        {
+            std::lock_guard<std::mutex> lock(m_event_waiter_mutex);
+            m_event_waiter = waiter;
+        }
+
+        void IPlatform::WakeEventWaiter()
+        {
+            shared_ptr<EventWaiter> waiter;
+            {
+                std::lock_guard<std::mutex> lock(m_event_waiter_mutex);
+                waiter = m_event_waiter.lock();
+            }
+
+            if(waiter) {
+                waiter->Wake();
+            }
+        }
     }
 }
@@ -17,9 +17,13 @@
 #ifndef KS_GUI_PLATFORM_HPP
 #define KS_GUI_PLATFORM_HPP
 
+#include <mutex>
 #include <ks/gui/KsGuiWindow.hpp>
+#include <ks/gui/KsGuiWindowChannel.hpp>
 #include <ks/gui/KsGuiScreen.hpp>
 #include <ks/gui/KsGuiInput.hpp>
+#include <ks/gui/KsGuiEventWaiter.hpp>
+#include <ks/gui/KsGuiContextConfigCache.hpp>
 
 namespace ks
 {
@@ -57,19 +61,89 @@ namespace ks
         };
 
 
+        // ============================================================= //
+
+        class IPlatformWindow;
+
+        // * A platform window Signal that's emitted by the
+        //   matching IPlatformWindow Notify method
+        // * Platforms used to emit these signals directly to
+        //   update the Window, but the Window now receives
+        //   notifications through a channel instead (see
+        //   IPlatformWindow::NotifySizeChanged). Emit is kept
+        //   for those platforms and forwards to the Notify
+        //   method so the Window is still updated.
+        template<typename... Args>
+        class PlatformWindowSignal final : private Signal<Args...>
+        {
+            friend class IPlatformWindow;
+
+        public:
+            using Signal<Args...>::Connect;
+            using Signal<Args...>::Disconnect;
+
+            // * Deprecated: call the IPlatformWindow Notify
+            //   method instead
+            void Emit(Args... args)
+            {
+                m_notify(args...);
+            }
+
+        private:
+            void emitSignal(Args... args)
+            {
+                Signal<Args...>::Emit(args...);
+            }
+
+            std::function<void(Args...)> m_notify;
+        };
+
         // ============================================================= //
 
         class IPlatformWindow
         {
         public:
+            IPlatformWindow();
+            IPlatformWindow(IPlatformWindow const &) = delete;
+            IPlatformWindow& operator=(IPlatformWindow const &) = delete;
             virtual ~IPlatformWindow() = default;
 
+            // * The Id of the Window created for this platform
+            //   window. Set by Application after creation.
+            // * Platforms should tag input events they
+            //   emit for this window with this Id
+            void SetWindowId(Id window_id);
+            Id GetWindowId() const;
+
             // Application ---> PlatformWindow
             virtual bool IsCurrentContext() = 0;
             virtual void MakeContextCurrent() = 0;
             virtual void ReleaseContext() = 0;
             virtual void SwapBuffers() = 0;
 
+            // * Sets the swap interval used by SwapBuffers from
+            //   the render thread with the context current,
+            //   without changing the swap_interval property
+            // * Used by PresentGroup so that only one window in a
+            //   group waits for vsync
+            // * Platforms that can do this must override both this
+            //   and GetHasContextSwapInterval. The default does
+            //   nothing, and PresentGroup warns that its windows
+            //   each wait for vsync.
+            virtual void SetContextSwapInterval(uint swap_interval);
+
+            // * Returns true if SetContextSwapInterval is
+            //   implemented; the default returns false
+            virtual bool GetHasContextSwapInterval() const;
+
+            // * Returns false if the window doesn't render with
+            //   a GL context (ie. it presents a software surface),
+            //   in which case the Window makes no GL calls of its
+            //   own such as frame pacing fences
+            // * Must not change after the window is created
+            // * The default returns true
+            virtual bool GetHasGLContext() const;
+
             virtual void SetSize(Window::Size const &size) = 0;
             virtual void SetPosition(Window::Position const &position) = 0;
             virtual void SetFullscreen(Window::FullscreenMode fullscreen) = 0;
@@ -80,16 +154,50 @@ namespace ks
             virtual void SetTitle(std::string const &title) = 0;
             virtual void Destroy() = 0;
 
+            // * Applies several property changes at once
+            // * The default calls the individual setters;
+            //   platforms that can change the window in one
+            //   request (ie. a single configure) should
+            //   override this to avoid intermediate resizes
+            virtual void ApplyProperties(Window::PropertyChanges const &changes);
+
             // PlatformWindow ---> Window
-            Signal<Window::Size> signal_size_changed;
-            Signal<Window::Position> signal_position_changed;
-            Signal<Window::FullscreenMode> signal_fullscreen_changed;
-            Signal<bool> signal_focused_changed;
-            Signal<bool> signal_visible_changed;
-            Signal<bool> signal_always_on_top_changed;
-            Signal<uint> signal_swap_interval_changed;
-            Signal<std::string> signal_title_changed;
-            Signal<> signal_close;
+            // * Platforms call these when the window changes.
+            //   Notifications are queued and delivered to the
+            //   Window in batches (see DrainNotifications).
+            // * Each also emits the matching signal below for
+            //   any other observers
+            void NotifySizeChanged(Window::Size const &size);
+            void NotifyPositionChanged(Window::Position const &position);
+            void NotifyFullscreenChanged(Window::FullscreenMode fullscreen);
+            void NotifyFocusedChanged(bool focused);
+            void NotifyVisibleChanged(bool visible);
+            void NotifyAlwaysOnTopChanged(bool always_on_top);
+            void NotifySwapIntervalChanged(uint swap_interval);
+            void NotifyTitleChanged(std::string const &title);
+            void NotifyClose();
+
+            // * Moves the queued notifications into
+            //   @list_notifications. Called by the Application.
+            void DrainNotifications(
+                    std::vector<WindowNotification> &list_notifications);
+
+            // * Emitted by the Notify methods for observers
+            //   other than the Window. Platforms must call the
+            //   Notify methods instead of emitting these.
+            PlatformWindowSignal<Window::Size> signal_size_changed;
+            PlatformWindowSignal<Window::Position> signal_position_changed;
+            PlatformWindowSignal<Window::FullscreenMode> signal_fullscreen_changed;
+            PlatformWindowSignal<bool> signal_focused_changed;
+            PlatformWindowSignal<bool> signal_visible_changed;
+            PlatformWindowSignal<bool> signal_always_on_top_changed;
+            PlatformWindowSignal<uint> signal_swap_interval_changed;
+            PlatformWindowSignal<std::string> signal_title_changed;
+            PlatformWindowSignal<> signal_close;
+
+        private:
+            Id m_window_id;
+            WindowNotifyChannel m_notify_channel;
         };
 
         // ============================================================= //
@@ -104,6 +212,32 @@ namespace ks
             virtual void Run() = 0;
             virtual void Quit() = 0;
 
+            // * Returns a file descriptor that is readable while
+            //   platform events are waiting to be processed (ie.
+            //   the display connection), or -1 if there isn't one
+            virtual int GetEventFd();
+
+            // * Blocks until platform events are waiting, @waiter
+            //   is woken or @timeout expires. A negative @timeout
+            //   doesn't expire.
+            // * The default implementation polls GetEventFd along
+            //   with @waiter, which lets the thread sleep while
+            //   idle. If the platform doesn't have an event fd it
+            //   can only poll: it sleeps for at most 10ms at a
+            //   time so that platform events are still picked up.
+            //   Such platforms should override this to wait on
+            //   @waiter alone and call WakeEventWaiter when events
+            //   arrive (see ShmPlatform).
+            // * Returns true if the wait ended because events
+            //   arrived or @waiter was woken, and false if it
+            //   timed out (for platforms without an event fd,
+            //   at the end of each polling interval)
+            virtual bool WaitEvents(EventWaiter& waiter,
+                                    Milliseconds timeout);
+
+            // * The waiter the Application passes to WaitEvents
+            void SetEventWaiter(shared_ptr<EventWaiter> waiter);
+
             // Display Screens
             virtual std::vector<shared_ptr<Screen const>> GetScreens() = 0;
 
@@ -115,6 +249,16 @@ namespace ks
 
             virtual void DestroyWindow(shared_ptr<IPlatformWindow>) = 0;
 
+            // * The cache of negotiated context configs, or
+            //   nullptr if caching is disabled
+            // * Platforms that search for a surface or context
+            //   config should Lookup the requested attributes in
+            //   CreateWindow before searching, Validate a cached
+            //   config once its context exists and Store the
+            //   result of a search
+            void SetContextConfigCache(shared_ptr<ContextConfigCache> cache);
+            shared_ptr<ContextConfigCache> const & GetContextConfigCache() const;
+
 
             Signal<> signal_init;
             Signal<> signal_pause;
@@ -125,10 +269,22 @@ namespace ks
             Signal<bool> signal_processed_events;
 
             Signal<KeyEvent> signal_keyboard_input;
-            Signal<std::string> signal_utf8_input;
+            Signal<TextInputEvent> signal_text_input;
+            Signal<std::string> signal_utf8_input; // deprecated
             Signal<MouseEvent> signal_mouse_input;
             Signal<TouchEvent> signal_touch_input;
             Signal<ScrollEvent> signal_scroll_input;
+
+        protected:
+            // * Wakes the waiter set with SetEventWaiter
+            // * Thread safe
+            void WakeEventWaiter();
+
+        private:
+            shared_ptr<ContextConfigCache> m_context_config_cache;
+
+            std::mutex m_event_waiter_mutex;
+            weak_ptr<EventWaiter> m_event_waiter;
         };
 
         // ============================================================= //
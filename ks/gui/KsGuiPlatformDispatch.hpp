@@ -0,0 +1,116 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_PLATFORM_DISPATCH_HPP
+#define KS_GUI_PLATFORM_DISPATCH_HPP
+
+#include <ks/gui/KsGuiPlatform.hpp>
+
+#ifdef KS_GUI_PLATFORM_WINDOW_TYPE
+    #include KS_GUI_PLATFORM_WINDOW_HEADER
+#endif
+
+namespace ks
+{
+    namespace gui
+    {
+        // ============================================================= //
+
+        // * Calls the render path operations of a platform window,
+        //   bound at compile time to KS_GUI_PLATFORM_WINDOW_TYPE
+        //   when it's defined (see KsGuiConfig.hpp) and through
+        //   IPlatformWindow's virtual methods otherwise
+        class PlatformWindowDispatch final
+        {
+        public:
+        #ifdef KS_GUI_PLATFORM_WINDOW_TYPE
+            using WindowType = KS_GUI_PLATFORM_WINDOW_TYPE;
+        #else
+            using WindowType = IPlatformWindow;
+        #endif
+
+            // * Throws if @platform_window can't be used with
+            //   the compile time backend
+            static void Check(IPlatformWindow* platform_window)
+            {
+            #ifdef KS_GUI_PLATFORM_WINDOW_TYPE
+                if(dynamic_cast<WindowType*>(platform_window) == nullptr) {
+                    throw WindowCreationFailed(
+                                "PlatformWindowDispatch: platform window "
+                                "isn't a KS_GUI_PLATFORM_WINDOW_TYPE");
+                }
+            #else
+                (void)platform_window;
+            #endif
+            }
+
+            static bool IsCurrentContext(IPlatformWindow* platform_window)
+            {
+            #ifdef KS_GUI_PLATFORM_WINDOW_TYPE
+                return static_cast<WindowType*>(platform_window)->
+                        WindowType::IsCurrentContext();
+            #else
+                return platform_window->IsCurrentContext();
+            #endif
+            }
+
+            static void MakeContextCurrent(IPlatformWindow* platform_window)
+            {
+            #ifdef KS_GUI_PLATFORM_WINDOW_TYPE
+                static_cast<WindowType*>(platform_window)->
+                        WindowType::MakeContextCurrent();
+            #else
+                platform_window->MakeContextCurrent();
+            #endif
+            }
+
+            static void ReleaseContext(IPlatformWindow* platform_window)
+            {
+            #ifdef KS_GUI_PLATFORM_WINDOW_TYPE
+                static_cast<WindowType*>(platform_window)->
+                        WindowType::ReleaseContext();
+            #else
+                platform_window->ReleaseContext();
+            #endif
+            }
+
+            static void SetContextSwapInterval(IPlatformWindow* platform_window,
+                                               uint swap_interval)
+            {
+            #ifdef KS_GUI_PLATFORM_WINDOW_TYPE
+                static_cast<WindowType*>(platform_window)->
+                        WindowType::SetContextSwapInterval(swap_interval);
+            #else
+                platform_window->SetContextSwapInterval(swap_interval);
+            #endif
+            }
+
+            static void SwapBuffers(IPlatformWindow* platform_window)
+            {
+            #ifdef KS_GUI_PLATFORM_WINDOW_TYPE
+                static_cast<WindowType*>(platform_window)->
+                        WindowType::SwapBuffers();
+            #else
+                platform_window->SwapBuffers();
+            #endif
+            }
+        };
+
+        // ============================================================= //
+    }
+}
+
+#endif // KS_GUI_PLATFORM_DISPATCH_HPP
@@ -0,0 +1,136 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <ks/gui/KsGuiPresentGroup.hpp>
+#include <ks/gui/KsGuiTrace.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        namespace {
+            // * Contexts are assumed to start with the interval
+            //   of their swap_interval property, so this forces
+            //   the first Present to set it
+            uint const g_unknown_swap_interval = ~uint(0);
+        }
+
+        // ============================================================= //
+
+        PresentGroupInvalid::PresentGroupInvalid(std::string msg) :
+            ks::Exception(ks::Exception::ErrorLevel::FATAL,std::move(msg),true)
+        {}
+
+        // ============================================================= //
+
+        PresentGroup::PresentGroup(std::vector<shared_ptr<Window>> const &list_windows) :
+            m_warned_swap_interval(false)
+        {
+            m_list_members.reserve(list_windows.size());
+            m_list_active.reserve(list_windows.size());
+
+            for(auto const &window : list_windows) {
+                Member member;
+                member.window = window;
+                member.context_swap_interval = g_unknown_swap_interval;
+                member.context_generation = 0;
+                m_list_members.push_back(member);
+            }
+        }
+
+        uint PresentGroup::Present(std::function<void(Window&)> const &render)
+        {
+            KS_GUI_TRACE_SCOPE("PresentGroup::Present",0);
+
+            m_list_active.clear();
+
+            for(auto& member : m_list_members) {
+                auto window = member.window.lock();
+                if(!window) {
+                    continue;
+                }
+
+                ActiveMember active;
+                active.context = window->AcquireRenderContext();
+                if(!active.context.IsValid()) {
+                    continue;
+                }
+
+                active.member = &member;
+                active.window = std::move(window);
+                m_list_active.push_back(std::move(active));
+            }
+
+            // Render everything first so no window's
+            // rendering waits behind another's vsync
+            for(auto& active : m_list_active) {
+                if(active.context.MakeCurrent()) {
+                    render(*(active.window));
+                }
+            }
+
+            // Present; only the last swap waits
+            uint presented = 0;
+
+            for(uint i=0; i < m_list_active.size(); i++) {
+                ActiveMember& active = m_list_active[i];
+
+                bool const last = (i+1 == m_list_active.size());
+                uint const swap_interval =
+                        last ? active.window->swap_interval.Get() : 0;
+
+                if(!active.context.MakeCurrent()) {
+                    continue;
+                }
+
+                // A recreated context starts with its own interval
+                u32 const context_generation = active.context.GetContextGeneration();
+                if(active.member->context_generation != context_generation) {
+                    active.member->context_generation = context_generation;
+                    active.member->context_swap_interval = g_unknown_swap_interval;
+                }
+
+                if(active.member->context_swap_interval != swap_interval) {
+                    if(!active.context.SetSwapInterval(swap_interval) &&
+                       !m_warned_swap_interval)
+                    {
+                        LOG.Warn() << "PresentGroup: The platform window can't "
+                                      "set the swap interval per swap, so each "
+                                      "window waits for its own vsync";
+                        m_warned_swap_interval = true;
+                    }
+
+                    active.member->context_swap_interval = swap_interval;
+                }
+
+                if(active.context.SwapBuffers()) {
+                    presented++;
+                }
+            }
+
+            m_list_active.clear();
+
+            return presented;
+        }
+
+        uint PresentGroup::GetWindowCount() const
+        {
+            return static_cast<uint>(m_list_members.size());
+        }
+
+        // ============================================================= //
+    }
+}
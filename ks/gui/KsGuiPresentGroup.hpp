@@ -0,0 +1,97 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_PRESENT_GROUP_HPP
+#define KS_GUI_PRESENT_GROUP_HPP
+
+#include <functional>
+#include <vector>
+#include <ks/gui/KsGuiWindow.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        // ============================================================= //
+
+        class PresentGroupInvalid : public ks::Exception
+        {
+        public:
+            PresentGroupInvalid(std::string msg);
+            ~PresentGroupInvalid() = default;
+        };
+
+        // ============================================================= //
+
+        // * Renders and presents a set of Windows that share
+        //   a render thread (EventLoop) together
+        // * Swapping each window with its own swap interval
+        //   blocks once per window, so N windows on one thread
+        //   would run at refresh/N. A PresentGroup swaps every
+        //   window but the last with an interval of zero and
+        //   only the last one waits for vsync.
+        // * Created with Application::CreatePresentGroup. The
+        //   group only holds weak references; closed windows
+        //   are skipped.
+        // * Needs platform windows that support
+        //   IPlatformWindow::SetContextSwapInterval; otherwise
+        //   a warning is logged and each window waits for its
+        //   own vsync
+        class PresentGroup final
+        {
+        public:
+            PresentGroup(std::vector<shared_ptr<Window>> const &list_windows);
+
+            // * Calls @render for each open member with its
+            //   context current, then swaps all of them
+            // * Must be called from the members' EventLoop
+            //   thread (ie. from a render task)
+            // * Returns the number of windows presented
+            uint Present(std::function<void(Window&)> const &render);
+
+            uint GetWindowCount() const;
+
+        private:
+            struct Member
+            {
+                weak_ptr<Window> window;
+
+                // * The interval last set on the context;
+                //   intervals are only set when they change
+                uint context_swap_interval;
+
+                // * The context generation the interval was set
+                //   for (see RenderContext::GetContextGeneration)
+                u32 context_generation;
+            };
+
+            struct ActiveMember
+            {
+                Member* member;
+                shared_ptr<Window> window;
+                RenderContext context;
+            };
+
+            std::vector<Member> m_list_members;
+            std::vector<ActiveMember> m_list_active;
+            bool m_warned_swap_interval;
+        };
+
+        // ============================================================= //
+    }
+}
+
+#endif // KS_GUI_PRESENT_GROUP_HPP
@@ -0,0 +1,680 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <ks/gui/KsGuiProgramCache.hpp>
+#include <ks/gui/KsGuiContextConfigCache.hpp>
+#include <ks/gui/KsGuiTrace.hpp>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <dirent.h>
+    #include <sys/stat.h>
+#endif
+
+namespace ks
+{
+    namespace gui
+    {
+        namespace {
+            u32 const g_binary_magic = 0x42505347; // "GSPB"
+            char const * const g_index_magic = "ks_gui_program_cache";
+
+            struct BinaryHeader
+            {
+                u32 magic;
+                u32 version;
+                u32 format;
+                u32 length;
+                u64 key;
+            };
+
+            // * FNV-1a
+            u64 const g_hash_seed = 0xCBF29CE484222325ULL;
+
+            u64 Hash(u64 hash, void const * data, size_t size)
+            {
+                u8 const * bytes = static_cast<u8 const *>(data);
+                for(size_t i=0; i < size; i++) {
+                    hash ^= bytes[i];
+                    hash *= 0x100000001B3ULL;
+                }
+                return hash;
+            }
+
+            GLuint CompileShader(ProgramCache::Shader const &shader)
+            {
+                GLuint const id = glCreateShader(shader.type);
+                if(id == 0) {
+                    return 0;
+                }
+
+                char const * source = shader.source.c_str();
+                GLint const length = static_cast<GLint>(shader.source.size());
+                glShaderSource(id,1,&source,&length);
+                glCompileShader(id);
+
+                GLint status = GL_FALSE;
+                glGetShaderiv(id,GL_COMPILE_STATUS,&status);
+
+                if(status != GL_TRUE) {
+                    GLint log_length = 0;
+                    glGetShaderiv(id,GL_INFO_LOG_LENGTH,&log_length);
+
+                    std::string log(std::max<GLint>(log_length,1),'\0');
+                    glGetShaderInfoLog(id,log_length,nullptr,&log[0]);
+
+                    LOG.Warn() << "ProgramCache: Failed to compile shader: "
+                               << log.c_str();
+
+                    glDeleteShader(id);
+                    return 0;
+                }
+
+                return id;
+            }
+
+            bool GetLinked(GLuint program)
+            {
+                GLint status = GL_FALSE;
+                glGetProgramiv(program,GL_LINK_STATUS,&status);
+                return (status == GL_TRUE);
+            }
+
+        #ifdef KS_GUI_PROGRAM_BINARY
+            // * @major is the desktop GL major version
+            bool GetHasExtension(char const * name, unsigned int major)
+            {
+            #ifdef GL_NUM_EXTENSIONS
+                // Core profiles only list extensions with glGetStringi
+                if(major >= 3) {
+                    GLint count = 0;
+                    glGetIntegerv(GL_NUM_EXTENSIONS,&count);
+                    for(GLint i=0; i < count; i++) {
+                        char const * extension =
+                                reinterpret_cast<char const *>(
+                                    glGetStringi(GL_EXTENSIONS,static_cast<GLuint>(i)));
+
+                        if(extension != nullptr && std::strcmp(extension,name) == 0) {
+                            return true;
+                        }
+                    }
+
+                    return false;
+                }
+            #else
+                (void)major;
+            #endif
+
+                char const * extensions =
+                        reinterpret_cast<char const *>(glGetString(GL_EXTENSIONS));
+
+                return (extensions != nullptr &&
+                        std::strstr(extensions,name) != nullptr);
+            }
+
+            // * The headers having the program binary calls
+            //   doesn't mean the context does: they need GL 4.1,
+            //   GLES 3 or ARB_get_program_binary, and a driver
+            //   with at least one binary format
+            bool GetContextHasProgramBinary()
+            {
+                char const * version =
+                        reinterpret_cast<char const *>(glGetString(GL_VERSION));
+
+                if(version == nullptr) {
+                    return false;
+                }
+
+                // ie. "OpenGL ES 3.0 ..." or "4.1.0 ..."
+                char const * const es_prefix = "OpenGL ES ";
+                size_t const es_prefix_length = std::strlen(es_prefix);
+                bool const es = (std::strncmp(version,es_prefix,es_prefix_length) == 0);
+
+                unsigned int major = 0;
+                unsigned int minor = 0;
+                std::sscanf(es ? version+es_prefix_length : version,
+                            "%u.%u",&major,&minor);
+
+                bool const supported =
+                        es ? (major >= 3) :
+                             (major > 4 || (major == 4 && minor >= 1) ||
+                              GetHasExtension("GL_ARB_get_program_binary",major));
+
+                if(!supported) {
+                    return false;
+                }
+
+                GLint formats = 0;
+                glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS,&formats);
+                return (formats > 0);
+            }
+        #endif
+
+            // * Calls @callback with the name and size of
+            //   each file in @dir
+            void ListFiles(std::string const &dir,
+                           std::function<void(std::string const &,u64)> const &callback)
+            {
+            #ifdef _WIN32
+                WIN32_FIND_DATAA data;
+                HANDLE const handle = FindFirstFileA((dir+"\\*").c_str(),&data);
+                if(handle == INVALID_HANDLE_VALUE) {
+                    return;
+                }
+
+                do {
+                    if((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0) {
+                        callback(data.cFileName,
+                                 (u64(data.nFileSizeHigh) << 32) | data.nFileSizeLow);
+                    }
+                }
+                while(FindNextFileA(handle,&data));
+
+                FindClose(handle);
+            #else
+                DIR* d = opendir(dir.c_str());
+                if(d == nullptr) {
+                    return;
+                }
+
+                while(dirent* entry = readdir(d)) {
+                    struct stat info;
+                    std::string const path = dir+"/"+entry->d_name;
+                    if(stat(path.c_str(),&info) == 0 && S_ISREG(info.st_mode)) {
+                        callback(entry->d_name,static_cast<u64>(info.st_size));
+                    }
+                }
+
+                closedir(d);
+            #endif
+            }
+
+            // * Binaries are named <key as 16 hex digits>.bin
+            //   (see ProgramCache::getPath)
+            bool ParseBinaryName(std::string const &name, u64 &key)
+            {
+                if(name.size() != 20 || name.compare(16,4,".bin") != 0) {
+                    return false;
+                }
+
+                key = 0;
+                for(size_t i=0; i < 16; i++) {
+                    char const c = name[i];
+                    if(!std::isxdigit(static_cast<unsigned char>(c))) {
+                        return false;
+                    }
+
+                    u64 const digit =
+                            (c <= '9') ? u64(c-'0') :
+                                         u64(std::tolower(static_cast<unsigned char>(c))-'a'+10);
+
+                    key = (key << 4) | digit;
+                }
+
+                return true;
+            }
+        }
+
+        // ============================================================= //
+
+        ProgramCache::ProgramCache(std::string dir, u64 max_size) :
+            m_dir(std::move(dir)),
+            m_max_size(max_size),
+            m_use_counter(0),
+            m_index_dirty(false),
+            m_stats{0,0,0,0,0,0}
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            loadIndex();
+        }
+
+        ProgramCache::~ProgramCache()
+        {
+            Flush();
+        }
+
+        GLuint ProgramCache::BuildProgram(std::vector<Shader> const &list_shaders,
+                                          std::function<void(GLuint)> const &pre_link)
+        {
+            KS_GUI_TRACE_SCOPE("ProgramCache::BuildProgram",0);
+
+            GLuint const program = glCreateProgram();
+            if(program == 0) {
+                return 0;
+            }
+
+            u64 const source_hash = HashSources(list_shaders);
+
+            if(LoadBinary(program,source_hash)) {
+                return program;
+            }
+
+            // Compile and link
+            std::vector<GLuint> list_ids;
+            list_ids.reserve(list_shaders.size());
+
+            bool compiled = true;
+            for(auto const &shader : list_shaders) {
+                GLuint const id = CompileShader(shader);
+                if(id == 0) {
+                    compiled = false;
+                    break;
+                }
+
+                glAttachShader(program,id);
+                list_ids.push_back(id);
+            }
+
+            bool linked = false;
+
+            if(compiled) {
+                if(pre_link) {
+                    pre_link(program);
+                }
+
+            #ifdef KS_GUI_PROGRAM_BINARY
+                if(GetContextHasProgramBinary()) {
+                    glProgramParameteri(program,GL_PROGRAM_BINARY_RETRIEVABLE_HINT,GL_TRUE);
+                }
+            #endif
+
+                glLinkProgram(program);
+                linked = GetLinked(program);
+
+                if(!linked) {
+                    GLint log_length = 0;
+                    glGetProgramiv(program,GL_INFO_LOG_LENGTH,&log_length);
+
+                    std::string log(std::max<GLint>(log_length,1),'\0');
+                    glGetProgramInfoLog(program,log_length,nullptr,&log[0]);
+
+                    LOG.Warn() << "ProgramCache: Failed to link program: "
+                               << log.c_str();
+                }
+            }
+
+            for(auto id : list_ids) {
+                glDetachShader(program,id);
+                glDeleteShader(id);
+            }
+
+            if(!linked) {
+                glDeleteProgram(program);
+                return 0;
+            }
+
+            StoreBinary(program,source_hash);
+
+            return program;
+        }
+
+        u64 ProgramCache::HashSources(std::vector<Shader> const &list_shaders)
+        {
+            u64 hash = g_hash_seed;
+            for(auto const &shader : list_shaders) {
+                u64 const type = shader.type;
+                u64 const size = shader.source.size();
+                hash = Hash(hash,&type,sizeof(type));
+                hash = Hash(hash,&size,sizeof(size));
+                hash = Hash(hash,shader.source.data(),shader.source.size());
+            }
+
+            return hash;
+        }
+
+        bool ProgramCache::LoadBinary(GLuint program, u64 source_hash)
+        {
+        #ifdef KS_GUI_PROGRAM_BINARY
+            if(!GetContextHasProgramBinary()) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stats.misses++;
+                return false;
+            }
+
+            u64 const key = getKey(source_hash);
+            u64 entry_size = 0;
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto it = find(key);
+                if(it == m_list_entries.end()) {
+                    m_stats.misses++;
+                    return false;
+                }
+
+                it->last_use = ++m_use_counter;
+                entry_size = it->size;
+                m_index_dirty = true;
+            }
+
+            // The length is read from disk, so it can't be
+            // more than the size the binary was indexed with
+            u64 const max_length =
+                    std::min(entry_size-std::min<u64>(entry_size,sizeof(BinaryHeader)),
+                             m_max_size);
+
+            // Read the binary outside of the lock
+            std::vector<u8> list_data;
+            BinaryHeader header;
+            bool valid = false;
+            {
+                std::ifstream file(getPath(key),std::ios::in|std::ios::binary);
+                if(file.read(reinterpret_cast<char*>(&header),sizeof(header)) &&
+                   header.magic == g_binary_magic &&
+                   header.version == FileVersion &&
+                   header.key == key &&
+                   header.length > 0 &&
+                   header.length <= max_length)
+                {
+                    list_data.resize(header.length);
+                    valid = static_cast<bool>(
+                                file.read(reinterpret_cast<char*>(&list_data[0]),
+                                          static_cast<std::streamsize>(header.length)));
+                }
+            }
+
+            if(valid) {
+                glProgramBinary(program,
+                                header.format,
+                                list_data.data(),
+                                static_cast<GLsizei>(list_data.size()));
+
+                valid = GetLinked(program);
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if(!valid) {
+                // Missing, corrupt or rejected by the driver
+                auto it = find(key);
+                if(it != m_list_entries.end()) {
+                    removeEntry(it);
+                }
+
+                m_stats.rejected++;
+                m_stats.misses++;
+                return false;
+            }
+
+            m_stats.hits++;
+            return true;
+        #else
+            (void)program;
+            (void)source_hash;
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.misses++;
+            return false;
+        #endif
+        }
+
+        void ProgramCache::StoreBinary(GLuint program, u64 source_hash)
+        {
+        #ifdef KS_GUI_PROGRAM_BINARY
+            if(!GetContextHasProgramBinary()) {
+                return;
+            }
+
+            GLint length = 0;
+            glGetProgramiv(program,GL_PROGRAM_BINARY_LENGTH,&length);
+
+            if(length <= 0 ||
+               static_cast<u64>(length) > m_max_size)
+            {
+                return;
+            }
+
+            std::vector<u8> list_data(static_cast<size_t>(length));
+            GLenum format = 0;
+            GLsizei written = 0;
+            glGetProgramBinary(program,length,&written,&format,&list_data[0]);
+
+            if(written <= 0) {
+                return;
+            }
+
+            u64 const key = getKey(source_hash);
+
+            BinaryHeader header;
+            header.magic = g_binary_magic;
+            header.version = FileVersion;
+            header.format = format;
+            header.length = static_cast<u32>(written);
+            header.key = key;
+
+            // Write to a temporary file and rename it so a
+            // concurrent load never reads a partial binary. The
+            // name is unique so processes storing the same
+            // binary don't write into the same file.
+            std::string const path = getPath(key);
+            std::string const tmp_path = ContextConfigCache::GetTempPath(path);
+            {
+                std::ofstream file(tmp_path,std::ios::out|std::ios::binary|std::ios::trunc);
+                file.write(reinterpret_cast<char const *>(&header),sizeof(header));
+                file.write(reinterpret_cast<char const *>(list_data.data()),written);
+
+                if(!file) {
+                    LOG.Warn() << "ProgramCache: Failed to write " << tmp_path;
+                    file.close();
+                    std::remove(tmp_path.c_str());
+                    return;
+                }
+            }
+
+            if(std::rename(tmp_path.c_str(),path.c_str()) != 0) {
+                LOG.Warn() << "ProgramCache: Failed to write " << path;
+                std::remove(tmp_path.c_str());
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            u64 const size = sizeof(header)+static_cast<u64>(written);
+
+            auto it = find(key);
+            if(it == m_list_entries.end()) {
+                m_list_entries.push_back(Entry{key,size,++m_use_counter});
+            }
+            else {
+                m_stats.size -= it->size;
+                it->size = size;
+                it->last_use = ++m_use_counter;
+            }
+
+            m_stats.size += size;
+            m_stats.stores++;
+            m_index_dirty = true;
+
+            evict();
+        #else
+            (void)program;
+            (void)source_hash;
+        #endif
+        }
+
+        ProgramCache::Stats ProgramCache::GetStats() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_stats;
+        }
+
+        void ProgramCache::Flush()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if(m_index_dirty) {
+                saveIndex();
+                m_index_dirty = false;
+            }
+        }
+
+        u64 ProgramCache::getKey(u64 source_hash)
+        {
+            std::string const identity = ContextConfigCache::GetDriverIdentity();
+            return Hash(source_hash,identity.data(),identity.size());
+        }
+
+        std::string ProgramCache::getPath(u64 key) const
+        {
+            std::ostringstream path;
+            path << m_dir << "/" << std::hex << std::setw(16)
+                 << std::setfill('0') << key << ".bin";
+
+            return path.str();
+        }
+
+        std::vector<ProgramCache::Entry>::iterator ProgramCache::find(u64 key)
+        {
+            return std::find_if(m_list_entries.begin(),
+                                m_list_entries.end(),
+                                [key](Entry const &entry) {
+                                    return (entry.key == key);
+                                });
+        }
+
+        void ProgramCache::removeEntry(std::vector<Entry>::iterator it)
+        {
+            std::remove(getPath(it->key).c_str());
+            m_stats.size -= std::min(m_stats.size,it->size);
+            m_list_entries.erase(it);
+            m_index_dirty = true;
+        }
+
+        void ProgramCache::evict()
+        {
+            while(m_stats.size > m_max_size && !m_list_entries.empty())
+            {
+                auto oldest =
+                        std::min_element(
+                            m_list_entries.begin(),
+                            m_list_entries.end(),
+                            [](Entry const &a, Entry const &b) {
+                                return (a.last_use < b.last_use);
+                            });
+
+                removeEntry(oldest);
+                m_stats.evictions++;
+            }
+        }
+
+        void ProgramCache::loadIndex()
+        {
+            // Index format:
+            // ks_gui_program_cache <version> <use counter>
+            // <key> <size> <last use>, one line per binary
+            std::vector<Entry> list_indexed;
+            {
+                std::ifstream file(m_dir+"/index");
+
+                std::string magic;
+                u32 version = 0;
+                file >> magic >> version >> m_use_counter;
+
+                if(file && magic == g_index_magic && version == FileVersion) {
+                    Entry entry;
+                    while(file >> std::hex >> entry.key >> std::dec
+                               >> entry.size >> entry.last_use)
+                    {
+                        list_indexed.push_back(entry);
+                    }
+                }
+                else {
+                    m_use_counter = 0;
+                }
+            }
+
+            std::sort(list_indexed.begin(),
+                      list_indexed.end(),
+                      [](Entry const &a, Entry const &b) {
+                          return (a.key < b.key);
+                      });
+
+            // The index is only written on Flush, so the entries
+            // come from the binaries actually in the directory:
+            // binaries stored after the last Flush (ie. by a
+            // process that didn't exit cleanly) are counted and
+            // can be evicted, and missing ones are dropped. The
+            // index only supplies the last use.
+            size_t indexed = 0;
+
+            ListFiles(m_dir,[&](std::string const &name, u64 size) {
+                u64 key;
+                if(!ParseBinaryName(name,key)) {
+                    return;
+                }
+
+                auto it = std::lower_bound(
+                            list_indexed.begin(),
+                            list_indexed.end(),
+                            key,
+                            [](Entry const &entry, u64 value) {
+                                return (entry.key < value);
+                            });
+
+                // Unindexed binaries are the first to be evicted
+                u64 last_use = 0;
+                if(it != list_indexed.end() && it->key == key) {
+                    last_use = it->last_use;
+                    indexed++;
+                }
+
+                m_list_entries.push_back(Entry{key,size,last_use});
+                m_stats.size += size;
+            });
+
+            m_index_dirty = (indexed != list_indexed.size() ||
+                             indexed != m_list_entries.size());
+
+            // In case the limit was lowered
+            evict();
+        }
+
+        void ProgramCache::saveIndex()
+        {
+            std::string const path = m_dir+"/index";
+            std::string const tmp_path = ContextConfigCache::GetTempPath(path);
+            {
+                std::ofstream file(tmp_path,std::ios::out|std::ios::trunc);
+                if(!file) {
+                    LOG.Warn() << "ProgramCache: Failed to open " << tmp_path;
+                    return;
+                }
+
+                file << g_index_magic << " " << FileVersion << " "
+                     << m_use_counter << "\n";
+
+                for(auto const &entry : m_list_entries) {
+                    file << std::hex << entry.key << std::dec << " "
+                         << entry.size << " " << entry.last_use << "\n";
+                }
+            }
+
+            if(std::rename(tmp_path.c_str(),path.c_str()) != 0) {
+                LOG.Warn() << "ProgramCache: Failed to write " << path;
+                std::remove(tmp_path.c_str());
+            }
+        }
+
+        // ============================================================= //
+    }
+}
@@ -0,0 +1,143 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_PROGRAM_CACHE_HPP
+#define KS_GUI_PROGRAM_CACHE_HPP
+
+#include <mutex>
+#include <vector>
+#include <functional>
+#include <ks/KsGlobal.hpp>
+#include <ks/gl/KsGLConfig.hpp>
+
+#if defined(GL_PROGRAM_BINARY_LENGTH)
+    #define KS_GUI_PROGRAM_BINARY 1
+#endif
+
+namespace ks
+{
+    namespace gui
+    {
+        // ============================================================= //
+
+        // * Caches linked program binaries on disk so programs
+        //   can be loaded with glProgramBinary instead of being
+        //   compiled and linked again on the next launch or
+        //   after a graphics reset
+        // * Binaries are keyed by a hash of the shader sources
+        //   and the GL vendor, renderer and version, so a driver
+        //   update never loads a stale binary. Binaries the
+        //   driver rejects anyway are removed and rebuilt.
+        // * The least recently used binaries are removed once
+        //   the cache is larger than its size limit
+        // * Shared between windows with Window::SetProgramCache.
+        //   Thread safe; the GL calls must be made with a
+        //   context current.
+        // * Without program binary support (ie. GLES 2) every
+        //   build is a miss and nothing is stored
+        class ProgramCache final
+        {
+        public:
+            static u32 const FileVersion = 1;
+
+            struct Shader final
+            {
+                GLenum type;
+                std::string source;
+            };
+
+            struct Stats final
+            {
+                u64 hits;
+                u64 misses;
+
+                // * Cached binaries the driver refused to load
+                u64 rejected;
+
+                u64 stores;
+                u64 evictions;
+
+                // * Total size of the cached binaries
+                u64 size;
+            };
+
+            // * Binaries are stored in @dir, which must exist
+            // * @max_size is the total size in bytes the
+            //   cached binaries may use
+            ProgramCache(std::string dir, u64 max_size);
+            ~ProgramCache();
+
+            ProgramCache(ProgramCache const &) = delete;
+            ProgramCache& operator=(ProgramCache const &) = delete;
+
+            // * Creates a program from @list_shaders. A cached
+            //   binary is used if there is one; otherwise the
+            //   shaders are compiled and linked and the binary
+            //   is cached.
+            // * @pre_link is called before a compiled program is
+            //   linked (ie. to bind attribute locations); cached
+            //   binaries keep the locations they were linked with
+            // * Returns 0 if the program couldn't be built
+            GLuint BuildProgram(std::vector<Shader> const &list_shaders,
+                                std::function<void(GLuint)> const &pre_link=nullptr);
+
+            // * For programs built elsewhere: LoadBinary links
+            //   @program from the binary cached for @source_hash
+            //   and returns false if there isn't a usable one.
+            //   StoreBinary caches the binary of a linked
+            //   program; set GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+            //   before linking it.
+            static u64 HashSources(std::vector<Shader> const &list_shaders);
+            bool LoadBinary(GLuint program, u64 source_hash);
+            void StoreBinary(GLuint program, u64 source_hash);
+
+            Stats GetStats() const;
+
+            // * Writes the index of cached binaries (also done
+            //   when the cache is destroyed)
+            void Flush();
+
+        private:
+            struct Entry
+            {
+                u64 key;
+                u64 size;
+                u64 last_use;
+            };
+
+            static u64 getKey(u64 source_hash);
+            std::string getPath(u64 key) const;
+            std::vector<Entry>::iterator find(u64 key);
+            void removeEntry(std::vector<Entry>::iterator it);
+            void evict();
+            void loadIndex();
+            void saveIndex();
+
+            std::string const m_dir;
+            u64 const m_max_size;
+
+            mutable std::mutex m_mutex;
+            std::vector<Entry> m_list_entries;
+            u64 m_use_counter;
+            bool m_index_dirty;
+            Stats m_stats;
+        };
+
+        // ============================================================= //
+    }
+}
+
+#endif // KS_GUI_PROGRAM_CACHE_HPP
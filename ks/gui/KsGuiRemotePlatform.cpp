@@ -0,0 +1,652 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <ks/gui/KsGuiRemotePlatform.hpp>
+
+#ifdef KS_GUI_SHM_PLATFORM_AVAILABLE
+    #include <sys/socket.h>
+    #include <sys/epoll.h>
+    #include <sys/un.h>
+    #include <sys/stat.h>
+    #include <poll.h>
+    #include <unistd.h>
+    #include <cerrno>
+    #include <cstring>
+    #include <cstdlib>
+    #include <algorithm>
+#endif
+
+namespace ks
+{
+    namespace gui
+    {
+    #ifdef KS_GUI_SHM_PLATFORM_AVAILABLE
+
+        namespace {
+            template<typename T>
+            void Write(std::vector<u8> &buffer, T value)
+            {
+                size_t const offset = buffer.size();
+                buffer.resize(offset+sizeof(T));
+                std::memcpy(&buffer[offset],&value,sizeof(T));
+            }
+
+            template<typename T>
+            void Overwrite(std::vector<u8> &buffer, size_t offset, T value)
+            {
+                std::memcpy(&buffer[offset],&value,sizeof(T));
+            }
+
+            template<typename T>
+            T Read(u8 const * data, uint offset)
+            {
+                T value;
+                std::memcpy(&value,data+offset,sizeof(T));
+                return value;
+            }
+
+            void WriteHeader(std::vector<u8> &buffer,
+                             RemoteProtocol::MessageType type)
+            {
+                Write<u32>(buffer,static_cast<u32>(type));
+                Write<u32>(buffer,0);
+            }
+
+            void FinishMessage(std::vector<u8> &buffer)
+            {
+                Overwrite<u32>(buffer,4,static_cast<u32>(
+                                   buffer.size()-RemoteProtocol::HeaderSize));
+            }
+        }
+
+        // ============================================================= //
+
+        Milliseconds const RemotePlatform::SendTimeout(1000);
+
+        RemotePlatform::RemotePlatform(shared_ptr<EventLoop> app_event_loop,
+                                       std::string socket_path,
+                                       Screen::Size screen_size,
+                                       Microseconds refresh_period) :
+            ShmPlatform(std::move(app_event_loop),screen_size,refresh_period),
+            m_socket_path(std::move(socket_path)),
+            m_listen_fd(-1),
+            m_epoll_fd(-1),
+            m_client_fd(-1),
+            m_watch_stopping(false)
+        {
+            sockaddr_un address;
+            std::memset(&address,0,sizeof(address));
+            address.sun_family = AF_UNIX;
+
+            if(m_socket_path.empty() ||
+               m_socket_path.size() >= sizeof(address.sun_path))
+            {
+                throw PlatformInitFailed(
+                            "RemotePlatform: Invalid socket path");
+            }
+
+            std::memcpy(address.sun_path,m_socket_path.c_str(),m_socket_path.size());
+
+            m_listen_fd = socket(AF_UNIX,SOCK_STREAM|SOCK_NONBLOCK|SOCK_CLOEXEC,0);
+            if(m_listen_fd < 0) {
+                throw PlatformInitFailed(
+                            "RemotePlatform: Failed to create socket");
+            }
+
+            // Only replace a stale socket; the path may be in a
+            // shared directory such as /tmp
+            struct stat info;
+            if(lstat(m_socket_path.c_str(),&info) == 0) {
+                if(!S_ISSOCK(info.st_mode)) {
+                    close(m_listen_fd);
+                    throw PlatformInitFailed(
+                                "RemotePlatform: "+m_socket_path+
+                                " exists and isn't a socket");
+                }
+
+                unlink(m_socket_path.c_str());
+            }
+
+            if(bind(m_listen_fd,
+                    reinterpret_cast<sockaddr*>(&address),
+                    sizeof(address)) != 0 ||
+               listen(m_listen_fd,1) != 0)
+            {
+                close(m_listen_fd);
+                throw PlatformInitFailed(
+                            "RemotePlatform: Failed to listen on "+m_socket_path);
+            }
+
+            m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+            if(m_epoll_fd < 0) {
+                close(m_listen_fd);
+                unlink(m_socket_path.c_str());
+                throw PlatformInitFailed(
+                            "RemotePlatform: Failed to create epoll fd");
+            }
+
+            epoll_event event;
+            event.events = EPOLLIN;
+            event.data.fd = m_listen_fd;
+            epoll_ctl(m_epoll_fd,EPOLL_CTL_ADD,m_listen_fd,&event);
+        }
+
+        RemotePlatform::~RemotePlatform()
+        {
+            if(m_watch_thread.joinable()) {
+                m_watch_stopping.store(true);
+                m_watch_waiter.Wake();
+                m_watch_thread.join();
+            }
+
+            closeClient();
+            close(m_epoll_fd);
+            close(m_listen_fd);
+            unlink(m_socket_path.c_str());
+        }
+
+        void RemotePlatform::ProcessEvents()
+        {
+            bool events_processed = false;
+
+            epoll_event list_events[2];
+            int const count = epoll_wait(m_epoll_fd,list_events,2,0);
+
+            for(int i=0; i < count; i++) {
+                if(list_events[i].data.fd == m_listen_fd) {
+                    acceptClients();
+                }
+                else {
+                    events_processed |= readClient();
+                }
+            }
+
+            signal_processed_events.Emit(events_processed);
+        }
+
+        void RemotePlatform::Run()
+        {
+            m_watch_stopping.store(false);
+            m_watch_thread = std::thread([this](){
+                this->watchEvents();
+            });
+
+            ShmPlatform::Run();
+
+            m_watch_stopping.store(true);
+            m_watch_waiter.Wake();
+            m_watch_thread.join();
+        }
+
+        void RemotePlatform::Quit()
+        {
+            ShmPlatform::Quit();
+        }
+
+        int RemotePlatform::GetEventFd()
+        {
+            return m_epoll_fd;
+        }
+
+        shared_ptr<IPlatformWindow>
+        RemotePlatform::CreateWindow(shared_ptr<EventLoop>& window_evl,
+                                     Window::Attributes& win_attrs,
+                                     Window::Properties& win_props)
+        {
+            auto platform_window =
+                    std::static_pointer_cast<ShmPlatformWindow>(
+                        ShmPlatform::CreateWindow(window_evl,win_attrs,win_props));
+
+            auto stream = make_shared<Stream>();
+            stream->window = platform_window.get();
+            stream->event_loop = window_evl;
+            stream->keyframe.store(true);
+            stream->keyframe_task_pending.store(false);
+
+            weak_ptr<Stream> weak_stream = stream;
+            stream->keyframe_task =
+                    make_shared<Task>(
+                        [this,weak_stream](){
+                            if(auto stream = weak_stream.lock()) {
+                                this->onKeyframeTask(*stream);
+                            }
+                        });
+
+            platform_window->SetPresentCallback(
+                        [this,stream](ShmPlatformWindow& window,
+                                      SoftwareSurface const &surface,
+                                      u64 frame_index) {
+                            this->onPresent(*stream,window,surface,frame_index);
+                        });
+
+            std::lock_guard<std::mutex> lock(m_streams_mutex);
+            m_list_streams.push_back(std::move(stream));
+
+            return platform_window;
+        }
+
+        void RemotePlatform::DestroyWindow(shared_ptr<IPlatformWindow> platform_window)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_streams_mutex);
+                m_list_streams.erase(
+                            std::remove_if(
+                                m_list_streams.begin(),
+                                m_list_streams.end(),
+                                [&](shared_ptr<Stream> const &stream) {
+                                    return (stream->window == platform_window.get());
+                                }),
+                            m_list_streams.end());
+            }
+
+            if(m_client_fd.load() >= 0) {
+                std::vector<u8> buffer;
+                WriteHeader(buffer,RemoteProtocol::MessageType::WindowClosed);
+                Write<u64>(buffer,platform_window->GetWindowId());
+                FinishMessage(buffer);
+                send(buffer);
+            }
+
+            ShmPlatform::DestroyWindow(platform_window);
+        }
+
+        void RemotePlatform::onPresent(Stream &stream,
+                                       ShmPlatformWindow &,
+                                       SoftwareSurface const &surface,
+                                       u64 frame_index)
+        {
+            if(m_client_fd.load(std::memory_order_relaxed) < 0) {
+                return;
+            }
+
+            sendFrame(stream,surface,frame_index);
+        }
+
+        void RemotePlatform::sendFrame(Stream &stream,
+                                       SoftwareSurface const &surface,
+                                       u64 frame_index)
+        {
+            if(stream.keyframe.exchange(false)) {
+                stream.encoder.Reset();
+            }
+
+            std::vector<u8> &buffer = stream.buffer;
+            buffer.clear();
+
+            WriteHeader(buffer,RemoteProtocol::MessageType::Frame);
+            Write<u64>(buffer,stream.window->GetWindowId());
+            Write<u64>(buffer,frame_index);
+            Write<u32>(buffer,surface.width);
+            Write<u32>(buffer,surface.height);
+            Write<u32>(buffer,TileEncoder::TileSize);
+
+            size_t const count_offset = buffer.size();
+            Write<u32>(buffer,0);
+
+            uint const tiles = stream.encoder.Encode(surface,buffer);
+            if(tiles == 0) {
+                // Nothing changed
+                return;
+            }
+
+            Overwrite<u32>(buffer,count_offset,tiles);
+            FinishMessage(buffer);
+
+            if(!send(buffer)) {
+                // The client missed these tiles
+                stream.keyframe.store(true);
+            }
+        }
+
+        void RemotePlatform::acceptClients()
+        {
+            while(true)
+            {
+                int const client_fd =
+                        accept4(m_listen_fd,nullptr,nullptr,
+                                SOCK_NONBLOCK|SOCK_CLOEXEC);
+
+                if(client_fd < 0) {
+                    break;
+                }
+
+                // Only one client; a new one replaces it
+                closeClient();
+
+                epoll_event event;
+                event.events = EPOLLIN;
+                event.data.fd = client_fd;
+                epoll_ctl(m_epoll_fd,EPOLL_CTL_ADD,client_fd,&event);
+
+                {
+                    std::lock_guard<std::mutex> lock(m_send_mutex);
+                    m_client_fd.store(client_fd);
+                }
+
+                m_recv_buffer.clear();
+                sendKeyframes(0);
+
+                LOG.Trace() << "RemotePlatform: Client connected";
+            }
+        }
+
+        bool RemotePlatform::readClient()
+        {
+            int const client_fd = m_client_fd.load();
+            if(client_fd < 0) {
+                return false;
+            }
+
+            bool closed = false;
+            u8 list_data[16384];
+
+            while(true) {
+                ssize_t const count = recv(client_fd,list_data,sizeof(list_data),0);
+                if(count > 0) {
+                    m_recv_buffer.insert(m_recv_buffer.end(),
+                                         list_data,
+                                         list_data+count);
+                }
+                else {
+                    closed = (count == 0 ||
+                              (errno != EAGAIN &&
+                               errno != EWOULDBLOCK &&
+                               errno != EINTR));
+                    break;
+                }
+            }
+
+            // Handle every complete message
+            bool events_processed = false;
+            size_t offset = 0;
+
+            while(m_recv_buffer.size()-offset >= RemoteProtocol::HeaderSize)
+            {
+                u8 const * header = &m_recv_buffer[offset];
+                u32 const type = Read<u32>(header,0);
+                u32 const size = Read<u32>(header,4);
+
+                if(size > RemoteProtocol::MaxMessageSize) {
+                    LOG.Warn() << "RemotePlatform: Invalid client message";
+                    closed = true;
+                    break;
+                }
+
+                if(m_recv_buffer.size()-offset-RemoteProtocol::HeaderSize < size) {
+                    break;
+                }
+
+                events_processed |=
+                        handleMessage(
+                            static_cast<RemoteProtocol::MessageType>(type),
+                            header+RemoteProtocol::HeaderSize,
+                            size);
+
+                offset += RemoteProtocol::HeaderSize+size;
+            }
+
+            m_recv_buffer.erase(m_recv_buffer.begin(),
+                                m_recv_buffer.begin()+offset);
+
+            if(closed) {
+                closeClient();
+                LOG.Trace() << "RemotePlatform: Client disconnected";
+            }
+
+            return events_processed;
+        }
+
+        bool RemotePlatform::handleMessage(RemoteProtocol::MessageType type,
+                                           u8 const * data,
+                                           u32 size)
+        {
+            using MessageType = RemoteProtocol::MessageType;
+
+            if(size < sizeof(u64)) {
+                return false;
+            }
+
+            Id const window_id = Read<u64>(data,0);
+
+            switch(type)
+            {
+                case MessageType::Key: {
+                    if(size < 18 || data[16] > u8(KeyEvent::Action::Repeat)) {
+                        return false;
+                    }
+
+                    KeyEvent event;
+                    event.key = static_cast<KeyEvent::Key>(Read<u32>(data,8));
+                    event.scancode = Read<u32>(data,12);
+                    event.action = static_cast<KeyEvent::Action>(data[16]);
+                    event.mods = data[17];
+                    event.window_id = window_id;
+                    signal_keyboard_input.Emit(event);
+                    return true;
+                }
+                case MessageType::Text: {
+                    TextInputEvent event(
+                                reinterpret_cast<char const *>(data+8),
+                                size-8,
+                                std::chrono::steady_clock::now(),
+                                window_id);
+                    signal_text_input.Emit(event);
+                    return true;
+                }
+                case MessageType::Mouse: {
+                    if(size < 18 || data[9] > u8(MouseEvent::Action::Release)) {
+                        return false;
+                    }
+
+                    MouseEvent event;
+                    event.button = static_cast<MouseEvent::Button>(data[8]);
+                    event.action = static_cast<MouseEvent::Action>(data[9]);
+                    event.x = Read<float>(data,10);
+                    event.y = Read<float>(data,14);
+                    event.timestamp = std::chrono::steady_clock::now();
+                    event.window_id = window_id;
+                    signal_mouse_input.Emit(event);
+                    return true;
+                }
+                case MessageType::Scroll: {
+                    if(size < 16) {
+                        return false;
+                    }
+
+                    ScrollEvent event;
+                    event.x = Read<float>(data,8);
+                    event.y = Read<float>(data,12);
+                    event.window_id = window_id;
+                    signal_scroll_input.Emit(event);
+                    return true;
+                }
+                case MessageType::Touch: {
+                    if(size < 18 || data[8] > u8(TouchEvent::Action::Release)) {
+                        return false;
+                    }
+
+                    TouchEvent event;
+                    event.action = static_cast<TouchEvent::Action>(data[8]);
+                    event.index = data[9];
+                    event.x = Read<float>(data,10);
+                    event.y = Read<float>(data,14);
+                    event.timestamp = std::chrono::steady_clock::now();
+                    event.window_id = window_id;
+                    signal_touch_input.Emit(event);
+                    return true;
+                }
+                case MessageType::Keyframe: {
+                    sendKeyframes(window_id);
+                    return false;
+                }
+                default: {
+                    // Ignore unknown messages
+                    return false;
+                }
+            }
+        }
+
+        void RemotePlatform::sendKeyframes(Id window_id)
+        {
+            std::lock_guard<std::mutex> lock(m_streams_mutex);
+            for(auto& stream : m_list_streams)
+            {
+                if(window_id != 0 && stream->window->GetWindowId() != window_id) {
+                    continue;
+                }
+
+                stream->keyframe.store(true);
+
+                // Sending can block for SendTimeout, so it's left
+                // to the render thread rather than stalling the
+                // app thread
+                if(stream->keyframe_task_pending.exchange(true)) {
+                    continue;
+                }
+
+                if(auto event_loop = stream->event_loop.lock()) {
+                    event_loop->PostTask(stream->keyframe_task);
+                }
+                else {
+                    stream->keyframe_task_pending.store(false);
+                }
+            }
+        }
+
+        void RemotePlatform::onKeyframeTask(Stream &stream)
+        {
+            stream.keyframe_task_pending.store(false);
+
+            // A frame presented since the request already
+            // sent the keyframe
+            if(!stream.keyframe.load() ||
+               m_client_fd.load(std::memory_order_relaxed) < 0)
+            {
+                return;
+            }
+
+            // The render thread is the only writer of the
+            // surface, so the presented buffer is stable here
+            SoftwareSurface surface;
+            u64 frame_index;
+            if(stream.window->GetPresentedSurface(surface,frame_index)) {
+                sendFrame(stream,surface,frame_index);
+            }
+        }
+
+        bool RemotePlatform::send(std::vector<u8> const &buffer)
+        {
+            std::lock_guard<std::mutex> lock(m_send_mutex);
+
+            int const client_fd = m_client_fd.load();
+            if(client_fd < 0) {
+                return false;
+            }
+
+            size_t offset = 0;
+            while(offset < buffer.size())
+            {
+                ssize_t const count =
+                        ::send(client_fd,
+                               &buffer[offset],
+                               buffer.size()-offset,
+                               MSG_NOSIGNAL);
+
+                if(count > 0) {
+                    offset += static_cast<size_t>(count);
+                    continue;
+                }
+
+                if(count < 0 && errno == EINTR) {
+                    continue;
+                }
+
+                if(count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                    pollfd poll_fd;
+                    poll_fd.fd = client_fd;
+                    poll_fd.events = POLLOUT;
+                    poll_fd.revents = 0;
+
+                    if(poll(&poll_fd,1,static_cast<int>(SendTimeout.count())) > 0) {
+                        continue;
+                    }
+                }
+
+                // Let the app thread close the connection;
+                // it sees the shutdown as a disconnect
+                LOG.Warn() << "RemotePlatform: Failed to send to client";
+                shutdown(client_fd,SHUT_RDWR);
+                return false;
+            }
+
+            return true;
+        }
+
+        void RemotePlatform::closeClient()
+        {
+            std::lock_guard<std::mutex> lock(m_send_mutex);
+
+            int const client_fd = m_client_fd.exchange(-1);
+            if(client_fd >= 0) {
+                epoll_ctl(m_epoll_fd,EPOLL_CTL_DEL,client_fd,nullptr);
+                close(client_fd);
+            }
+        }
+
+        void RemotePlatform::watchEvents()
+        {
+            while(!m_watch_stopping.load())
+            {
+                if(!m_watch_waiter.Wait(Milliseconds(1000),m_epoll_fd)) {
+                    continue;
+                }
+
+                if(m_watch_stopping.load()) {
+                    break;
+                }
+
+                GetAppEventLoop()->PostTask(
+                            make_shared<Task>(
+                                [this](){
+                                    this->ProcessEvents();
+                                    m_watch_waiter.Wake();
+                                }));
+
+                // The event fd stays readable until the events
+                // are processed so wait for the task first
+                m_watch_waiter.Wait(Milliseconds(1000));
+            }
+        }
+
+        // ============================================================= //
+
+    #ifdef KS_GUI_PLATFORM_REMOTE
+        shared_ptr<IPlatform> CreatePlatform(shared_ptr<EventLoop> app_event_loop)
+        {
+            char const * socket_path = std::getenv("KS_GUI_REMOTE_SOCKET");
+
+            return make_shared<RemotePlatform>(
+                        std::move(app_event_loop),
+                        socket_path ? socket_path : "/tmp/ks_gui_remote.sock",
+                        Screen::Size(ShmPlatform::DefaultScreenWidth,
+                                     ShmPlatform::DefaultScreenHeight),
+                        Microseconds(16667));
+        }
+    #endif
+
+    #endif // KS_GUI_SHM_PLATFORM_AVAILABLE
+    }
+}
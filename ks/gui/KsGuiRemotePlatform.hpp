@@ -0,0 +1,192 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_REMOTE_PLATFORM_HPP
+#define KS_GUI_REMOTE_PLATFORM_HPP
+
+#include <thread>
+#include <ks/gui/KsGuiShmPlatform.hpp>
+#include <ks/gui/KsGuiTileEncoder.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        // ============================================================= //
+
+        // * Messages are a u32 MessageType and a u32 payload
+        //   size followed by the payload. All values are
+        //   little endian; window ids are u64.
+        // * Server ---> Client
+        //   Frame:         window id, u64 frame index,
+        //                  u32 width, u32 height, u32 tile size,
+        //                  u32 tile count, tiles (see TileEncoder)
+        //   WindowClosed:  window id
+        // * Client ---> Server
+        //   Key:           window id, u32 key, u32 scancode,
+        //                  u8 action, u8 mods
+        //   Text:          window id, utf8 text
+        //   Mouse:         window id, u8 button, u8 action,
+        //                  f32 x, f32 y
+        //   Scroll:        window id, f32 x, f32 y
+        //   Touch:         window id, u8 action, u8 index,
+        //                  f32 x, f32 y
+        //   Keyframe:      window id (0 for all windows); the
+        //                  next frame contains every tile
+        struct RemoteProtocol final
+        {
+            enum class MessageType : u32
+            {
+                Frame = 1,
+                WindowClosed = 2,
+
+                Key = 16,
+                Text = 17,
+                Mouse = 18,
+                Scroll = 19,
+                Touch = 20,
+                Keyframe = 21
+            };
+
+            static uint const HeaderSize = 8;
+
+            // * Larger client messages close the connection
+            static uint const MaxMessageSize = 64*1024;
+        };
+
+        // ============================================================= //
+
+    #ifdef KS_GUI_SHM_PLATFORM_AVAILABLE
+
+        // * A headless platform that streams presented frames
+        //   to one client over a Unix domain socket and injects
+        //   the input events the client sends
+        // * Windows are ShmPlatformWindows. Only the tiles that
+        //   changed since the last frame are sent and a new
+        //   client first receives every tile.
+        // * Frames are encoded and sent on the render thread;
+        //   a client that doesn't keep up blocks rendering and
+        //   is dropped if it stalls for SendTimeout
+        class RemotePlatform final : public ShmPlatform
+        {
+        public:
+            static Milliseconds const SendTimeout;
+
+            // * Listens on @socket_path, replacing any
+            //   existing socket file. Fails if something
+            //   other than a socket is at the path.
+            // * Throws PlatformInitFailed on failure
+            RemotePlatform(shared_ptr<EventLoop> app_event_loop,
+                           std::string socket_path,
+                           Screen::Size screen_size,
+                           Microseconds refresh_period);
+
+            ~RemotePlatform();
+
+            // * Accepts clients and emits the input they sent
+            void ProcessEvents() override;
+
+            // * Runs the app EventLoop; client input is
+            //   processed as it arrives
+            void Run() override;
+            void Quit() override;
+
+            // * Readable while a client is connecting or
+            //   has sent input
+            int GetEventFd() override;
+
+            shared_ptr<IPlatformWindow>
+            CreateWindow(shared_ptr<EventLoop>& window_evl,
+                         Window::Attributes& win_attrs,
+                         Window::Properties& win_props) override;
+
+            void DestroyWindow(shared_ptr<IPlatformWindow> platform_window) override;
+
+        private:
+            struct Stream
+            {
+                ShmPlatformWindow* window;
+                weak_ptr<EventLoop> event_loop;
+
+                // * Only used on the window's render thread
+                TileEncoder encoder;
+                std::vector<u8> buffer;
+
+                // * Set to send every tile with the next frame
+                std::atomic<bool> keyframe;
+
+                // * Sends a keyframe of the presented frame from
+                //   the render thread, for windows that aren't
+                //   rendering. Posted once while pending.
+                shared_ptr<Task> keyframe_task;
+                std::atomic<bool> keyframe_task_pending;
+            };
+
+            void onPresent(Stream &stream,
+                           ShmPlatformWindow &window,
+                           SoftwareSurface const &surface,
+                           u64 frame_index);
+
+            // * Encodes and sends the tiles of @surface that
+            //   changed. Called on the window's render thread.
+            void sendFrame(Stream &stream,
+                           SoftwareSurface const &surface,
+                           u64 frame_index);
+
+            void acceptClients();
+            bool readClient();
+            bool handleMessage(RemoteProtocol::MessageType type,
+                               u8 const * data,
+                               u32 size);
+            // * Has the last presented frame of each matching
+            //   window sent in full by its render thread right
+            //   away, so that idle windows that aren't rendering
+            //   are still shown. Doesn't block.
+            void sendKeyframes(Id window_id);
+            void onKeyframeTask(Stream &stream);
+            bool send(std::vector<u8> const &buffer);
+            void closeClient();
+            void watchEvents();
+
+            std::string const m_socket_path;
+            int m_listen_fd;
+            int m_epoll_fd;
+
+            // * Written by the app thread with m_send_mutex
+            //   locked; render threads only send with it locked
+            std::mutex m_send_mutex;
+            std::atomic<int> m_client_fd;
+
+            // * App thread only
+            std::vector<u8> m_recv_buffer;
+
+            std::mutex m_streams_mutex;
+            std::vector<shared_ptr<Stream>> m_list_streams;
+
+            // * Processes client input while Run is blocked
+            //   in the app EventLoop
+            std::thread m_watch_thread;
+            std::atomic<bool> m_watch_stopping;
+            EventWaiter m_watch_waiter;
+        };
+
+    #endif // KS_GUI_SHM_PLATFORM_AVAILABLE
+
+        // ============================================================= //
+    }
+}
+
+#endif // KS_GUI_REMOTE_PLATFORM_HPP
@@ -0,0 +1,584 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <ks/gui/KsGuiShmPlatform.hpp>
+
+#ifdef KS_GUI_SHM_PLATFORM_AVAILABLE
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <linux/memfd.h>
+    #include <thread>
+    #include <new>
+    #include <algorithm>
+#endif
+
+namespace ks
+{
+    namespace gui
+    {
+        // ============================================================= //
+
+        ShmFrameReaderError::ShmFrameReaderError(std::string msg) :
+            ks::Exception(ks::Exception::ErrorLevel::FATAL,std::move(msg),true)
+        {}
+
+        // ============================================================= //
+
+    #ifdef KS_GUI_SHM_PLATFORM_AVAILABLE
+
+        namespace {
+            size_t const g_page_size = 4096;
+
+            size_t AlignToPage(size_t size)
+            {
+                return ((size+g_page_size-1)/g_page_size)*g_page_size;
+            }
+
+            thread_local ShmPlatformWindow* t_current_window = nullptr;
+        }
+
+        // ============================================================= //
+
+        ShmFrameReader::ShmFrameReader(std::string const &path) :
+            m_mapping(nullptr),
+            m_mapping_size(0),
+            m_header(nullptr)
+        {
+            int const fd = open(path.c_str(),O_RDONLY|O_CLOEXEC);
+            if(fd < 0) {
+                throw ShmFrameReaderError(
+                            "ShmFrameReader: Failed to open "+path);
+            }
+
+            struct stat file_stat;
+            if(fstat(fd,&file_stat) != 0 ||
+               static_cast<size_t>(file_stat.st_size) < sizeof(ShmFrameHeader))
+            {
+                close(fd);
+                throw ShmFrameReaderError(
+                            "ShmFrameReader: Invalid framebuffer size");
+            }
+
+            m_mapping_size = static_cast<size_t>(file_stat.st_size);
+
+            void* mapping = mmap(nullptr,m_mapping_size,PROT_READ,MAP_SHARED,fd,0);
+            close(fd);
+
+            if(mapping == MAP_FAILED) {
+                throw ShmFrameReaderError(
+                            "ShmFrameReader: Failed to map framebuffer");
+            }
+
+            m_mapping = static_cast<u8*>(mapping);
+            m_header = reinterpret_cast<ShmFrameHeader const *>(m_mapping);
+
+            // Check that every buffer is within the mapping
+            bool valid =
+                    m_header->magic == ShmFrameHeader::Magic &&
+                    m_header->version == ShmFrameHeader::Version &&
+                    m_header->buffer_count == ShmFrameHeader::BufferCount &&
+                    m_header->stride >= m_header->max_width*4 &&
+                    m_header->buffer_size >=
+                        u64(m_header->stride)*m_header->max_height;
+
+            for(uint i=0; valid && i < ShmFrameHeader::BufferCount; i++) {
+                valid = (m_header->buffer_offset[i] <= m_mapping_size &&
+                         m_header->buffer_size <=
+                            m_mapping_size-m_header->buffer_offset[i]);
+            }
+
+            if(!valid) {
+                munmap(m_mapping,m_mapping_size);
+                throw ShmFrameReaderError(
+                            "ShmFrameReader: "+path+" is not a framebuffer");
+            }
+        }
+
+        ShmFrameReader::~ShmFrameReader()
+        {
+            munmap(m_mapping,m_mapping_size);
+        }
+
+        u64 ShmFrameReader::GetFrameIndex() const
+        {
+            return m_header->frame_index.load(std::memory_order_acquire);
+        }
+
+        bool ShmFrameReader::GetClosed() const
+        {
+            return (m_header->closed.load(std::memory_order_acquire) != 0);
+        }
+
+        bool ShmFrameReader::AcquireFrame(Frame &frame) const
+        {
+            u64 const index = m_header->frame_index.load(std::memory_order_acquire);
+            if(index == 0) {
+                return false;
+            }
+
+            uint const buffer = index % ShmFrameHeader::BufferCount;
+
+            frame.index = index;
+            frame.surface.data = m_mapping+m_header->buffer_offset[buffer];
+            frame.surface.width =
+                    std::min(m_header->buffer_width[buffer],m_header->max_width);
+            frame.surface.height =
+                    std::min(m_header->buffer_height[buffer],m_header->max_height);
+            frame.surface.stride = m_header->stride;
+
+            return true;
+        }
+
+        bool ShmFrameReader::ValidateFrame(Frame const &frame) const
+        {
+            // Order the reads of the frame before the check
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return (m_header->frame_index.load(std::memory_order_relaxed) ==
+                    frame.index);
+        }
+
+        // ============================================================= //
+
+        ShmPlatformWindow::ShmPlatformWindow(Window::Properties const &win_props,
+                                             Screen::Size const &max_size,
+                                             Microseconds refresh_period,
+                                             std::function<void()> on_notify) :
+            m_max_size(max_size),
+            m_refresh_period(refresh_period),
+            m_on_notify(std::move(on_notify)),
+            m_fd(-1),
+            m_mapping(nullptr),
+            m_mapping_size(0),
+            m_header(nullptr),
+            m_fullscreen(win_props.fullscreen),
+            m_context_swap_interval(win_props.swap_interval),
+            m_last_swap(std::chrono::steady_clock::now()),
+            m_frame_begun(false)
+        {
+            uint const stride = m_max_size.first*4;
+            size_t const buffer_size =
+                    AlignToPage(size_t(stride)*m_max_size.second);
+            size_t const header_size = AlignToPage(sizeof(ShmFrameHeader));
+
+            m_mapping_size =
+                    header_size+(buffer_size*ShmFrameHeader::BufferCount);
+
+            m_fd = static_cast<int>(
+                        syscall(SYS_memfd_create,"ks_gui_framebuffer",
+                                MFD_CLOEXEC|MFD_ALLOW_SEALING));
+            if(m_fd < 0) {
+                throw WindowCreationFailed(
+                            "ShmPlatformWindow: Failed to create memfd");
+            }
+
+            if(ftruncate(m_fd,static_cast<off_t>(m_mapping_size)) != 0) {
+                close(m_fd);
+                throw WindowCreationFailed(
+                            "ShmPlatformWindow: Failed to size memfd");
+            }
+
+            // The size never changes so readers can't fault
+            // on a truncated mapping
+            fcntl(m_fd,F_ADD_SEALS,F_SEAL_SHRINK|F_SEAL_GROW|F_SEAL_SEAL);
+
+            void* mapping = mmap(nullptr,m_mapping_size,
+                                 PROT_READ|PROT_WRITE,MAP_SHARED,m_fd,0);
+            if(mapping == MAP_FAILED) {
+                close(m_fd);
+                throw WindowCreationFailed(
+                            "ShmPlatformWindow: Failed to map memfd");
+            }
+
+            m_mapping = static_cast<u8*>(mapping);
+
+            // The memfd is zero filled
+            m_header = new (m_mapping) ShmFrameHeader;
+            m_header->magic = ShmFrameHeader::Magic;
+            m_header->version = ShmFrameHeader::Version;
+            m_header->max_width = m_max_size.first;
+            m_header->max_height = m_max_size.second;
+            m_header->stride = stride;
+            m_header->buffer_count = ShmFrameHeader::BufferCount;
+            m_header->buffer_size = buffer_size;
+            for(uint i=0; i < ShmFrameHeader::BufferCount; i++) {
+                m_header->buffer_offset[i] = header_size+(buffer_size*i);
+                m_header->buffer_width[i] = 0;
+                m_header->buffer_height[i] = 0;
+            }
+            m_header->closed.store(0,std::memory_order_relaxed);
+            m_header->frame_index.store(0,std::memory_order_release);
+
+            m_windowed_size = clampSize(Window::Size(win_props.width,win_props.height));
+            m_size = (m_fullscreen == Window::FullscreenMode::None) ?
+                        m_windowed_size : m_max_size;
+            m_frame_size = m_size;
+        }
+
+        ShmPlatformWindow::~ShmPlatformWindow()
+        {
+            if(t_current_window == this) {
+                t_current_window = nullptr;
+            }
+
+            m_header->closed.store(1,std::memory_order_release);
+            munmap(m_mapping,m_mapping_size);
+            close(m_fd);
+        }
+
+        ShmPlatformWindow* ShmPlatformWindow::GetCurrent()
+        {
+            return t_current_window;
+        }
+
+        SoftwareSurface ShmPlatformWindow::GetSurface()
+        {
+            if(!m_frame_begun) {
+                beginFrame();
+            }
+
+            u64 const next_index =
+                    m_header->frame_index.load(std::memory_order_relaxed)+1;
+            uint const buffer = next_index % ShmFrameHeader::BufferCount;
+
+            SoftwareSurface surface;
+            surface.data = m_mapping+m_header->buffer_offset[buffer];
+            surface.width = m_frame_size.first;
+            surface.height = m_frame_size.second;
+            surface.stride = m_header->stride;
+
+            return surface;
+        }
+
+        int ShmPlatformWindow::GetFd() const
+        {
+            return m_fd;
+        }
+
+        std::string ShmPlatformWindow::GetPath() const
+        {
+            return "/proc/"+std::to_string(getpid())+"/fd/"+std::to_string(m_fd);
+        }
+
+        u64 ShmPlatformWindow::GetFrameIndex() const
+        {
+            return m_header->frame_index.load(std::memory_order_acquire);
+        }
+
+        bool ShmPlatformWindow::GetPresentedSurface(SoftwareSurface &surface,
+                                                    u64 &frame_index) const
+        {
+            frame_index = m_header->frame_index.load(std::memory_order_acquire);
+            if(frame_index == 0) {
+                return false;
+            }
+
+            uint const buffer = frame_index % ShmFrameHeader::BufferCount;
+
+            surface.data = m_mapping+m_header->buffer_offset[buffer];
+            surface.width = m_header->buffer_width[buffer];
+            surface.height = m_header->buffer_height[buffer];
+            surface.stride = m_header->stride;
+
+            return true;
+        }
+
+        void ShmPlatformWindow::SetPresentCallback(PresentCallback callback)
+        {
+            m_present_callback = std::move(callback);
+        }
+
+        bool ShmPlatformWindow::IsCurrentContext()
+        {
+            return (t_current_window == this);
+        }
+
+        void ShmPlatformWindow::MakeContextCurrent()
+        {
+            t_current_window = this;
+
+            if(!m_frame_begun) {
+                beginFrame();
+            }
+        }
+
+        void ShmPlatformWindow::ReleaseContext()
+        {
+            if(t_current_window == this) {
+                t_current_window = nullptr;
+            }
+        }
+
+        void ShmPlatformWindow::SwapBuffers()
+        {
+            if(!m_frame_begun) {
+                beginFrame();
+            }
+
+            // There's no display; pace swaps to the virtual
+            // screen's refresh rate instead
+            uint const swap_interval =
+                    m_context_swap_interval.load(std::memory_order_relaxed);
+
+            if(swap_interval > 0) {
+                TimePoint const deadline =
+                        m_last_swap+(m_refresh_period*swap_interval);
+                std::this_thread::sleep_until(deadline);
+            }
+
+            m_last_swap = std::chrono::steady_clock::now();
+
+            u64 const index =
+                    m_header->frame_index.load(std::memory_order_relaxed)+1;
+            uint const buffer = index % ShmFrameHeader::BufferCount;
+
+            m_header->buffer_width[buffer] = m_frame_size.first;
+            m_header->buffer_height[buffer] = m_frame_size.second;
+            m_header->frame_index.store(index,std::memory_order_release);
+
+            m_frame_begun = false;
+
+            if(m_present_callback) {
+                SoftwareSurface surface;
+                surface.data = m_mapping+m_header->buffer_offset[buffer];
+                surface.width = m_frame_size.first;
+                surface.height = m_frame_size.second;
+                surface.stride = m_header->stride;
+
+                m_present_callback(*this,surface,index);
+            }
+        }
+
+        bool ShmPlatformWindow::GetHasGLContext() const
+        {
+            // Frames are rendered into the software surface
+            return false;
+        }
+
+        bool ShmPlatformWindow::GetHasContextSwapInterval() const
+        {
+            return true;
+        }
+
+        void ShmPlatformWindow::SetContextSwapInterval(uint swap_interval)
+        {
+            m_context_swap_interval.store(swap_interval,std::memory_order_relaxed);
+        }
+
+        void ShmPlatformWindow::SetSize(Window::Size const &size)
+        {
+            Window::Size new_size = clampSize(size);
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_windowed_size = new_size;
+                if(m_fullscreen == Window::FullscreenMode::None) {
+                    m_size = new_size;
+                }
+                else {
+                    new_size = m_size;
+                }
+            }
+
+            NotifySizeChanged(new_size);
+            m_on_notify();
+        }
+
+        void ShmPlatformWindow::SetPosition(Window::Position const &position)
+        {
+            NotifyPositionChanged(position);
+            m_on_notify();
+        }
+
+        void ShmPlatformWindow::SetFullscreen(Window::FullscreenMode fullscreen)
+        {
+            Window::Size new_size;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_fullscreen = fullscreen;
+                m_size = (m_fullscreen == Window::FullscreenMode::None) ?
+                            m_windowed_size : m_max_size;
+                new_size = m_size;
+            }
+
+            NotifyFullscreenChanged(fullscreen);
+            NotifySizeChanged(new_size);
+            m_on_notify();
+        }
+
+        void ShmPlatformWindow::SetFocused(bool focused)
+        {
+            NotifyFocusedChanged(focused);
+            m_on_notify();
+        }
+
+        void ShmPlatformWindow::SetVisible(bool visible)
+        {
+            NotifyVisibleChanged(visible);
+            m_on_notify();
+        }
+
+        void ShmPlatformWindow::SetAlwaysOnTop(bool always_on_top)
+        {
+            NotifyAlwaysOnTopChanged(always_on_top);
+            m_on_notify();
+        }
+
+        void ShmPlatformWindow::SetSwapInterval(uint swap_interval)
+        {
+            // Applies from the next swap
+            m_context_swap_interval.store(swap_interval,std::memory_order_relaxed);
+            NotifySwapIntervalChanged(swap_interval);
+            m_on_notify();
+        }
+
+        void ShmPlatformWindow::SetTitle(std::string const &title)
+        {
+            NotifyTitleChanged(title);
+            m_on_notify();
+        }
+
+        void ShmPlatformWindow::Destroy()
+        {
+            m_header->closed.store(1,std::memory_order_release);
+        }
+
+        Window::Size ShmPlatformWindow::clampSize(Window::Size size) const
+        {
+            size.first = std::max(1u,std::min(size.first,m_max_size.first));
+            size.second = std::max(1u,std::min(size.second,m_max_size.second));
+            return size;
+        }
+
+        void ShmPlatformWindow::beginFrame()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_frame_size = m_size;
+            m_frame_begun = true;
+        }
+
+        // ============================================================= //
+
+        uint const ShmPlatform::DefaultScreenWidth;
+        uint const ShmPlatform::DefaultScreenHeight;
+
+        ShmPlatform::ShmPlatform(shared_ptr<EventLoop> app_event_loop,
+                                 Screen::Size screen_size,
+                                 Microseconds refresh_period) :
+            m_app_event_loop(std::move(app_event_loop)),
+            m_screen_size(screen_size),
+            m_refresh_period(refresh_period),
+            m_screen(make_shared<Screen>(
+                         "shm",
+                         Screen::Rotation::CW_0,
+                         screen_size.first,
+                         screen_size.second,
+                         96.0f,
+                         96.0f)),
+            m_notify_pending(make_shared<std::atomic<bool>>(false))
+        {}
+
+        void ShmPlatform::ProcessEvents()
+        {
+            // No input
+            signal_processed_events.Emit(false);
+        }
+
+        bool ShmPlatform::WaitEvents(EventWaiter& waiter,
+                                     Milliseconds timeout)
+        {
+            return waiter.Wait(timeout);
+        }
+
+        void ShmPlatform::Run()
+        {
+            m_app_event_loop->Run();
+        }
+
+        void ShmPlatform::Quit()
+        {
+            m_app_event_loop->Stop();
+        }
+
+        std::vector<shared_ptr<Screen const>> ShmPlatform::GetScreens()
+        {
+            return std::vector<shared_ptr<Screen const>>{m_screen};
+        }
+
+        shared_ptr<IPlatformWindow>
+        ShmPlatform::CreateWindow(shared_ptr<EventLoop>&,
+                                  Window::Attributes&,
+                                  Window::Properties& win_props)
+        {
+            return make_shared<ShmPlatformWindow>(
+                        win_props,
+                        m_screen_size,
+                        m_refresh_period,
+                        [this](){
+                            this->onWindowNotify();
+                        });
+        }
+
+        void ShmPlatform::DestroyWindow(shared_ptr<IPlatformWindow> platform_window)
+        {
+            platform_window->Destroy();
+        }
+
+        shared_ptr<EventLoop> const & ShmPlatform::GetAppEventLoop() const
+        {
+            return m_app_event_loop;
+        }
+
+        void ShmPlatform::onWindowNotify()
+        {
+            // Have the Application flush window notifications
+            // (it does so on signal_processed_events) once for
+            // all of the changes made by the current task
+            if(m_notify_pending->exchange(true)) {
+                return;
+            }
+
+            auto notify_pending = m_notify_pending;
+
+            m_app_event_loop->PostTask(
+                        make_shared<Task>(
+                            [this,notify_pending](){
+                                notify_pending->store(false);
+                                this->signal_processed_events.Emit(false);
+                            }));
+
+            WakeEventWaiter();
+        }
+
+        // ============================================================= //
+
+    #ifdef KS_GUI_PLATFORM_SHM
+        shared_ptr<IPlatform> CreatePlatform(shared_ptr<EventLoop> app_event_loop)
+        {
+            return make_shared<ShmPlatform>(
+                        std::move(app_event_loop),
+                        Screen::Size(ShmPlatform::DefaultScreenWidth,
+                                     ShmPlatform::DefaultScreenHeight),
+                        Microseconds(16667));
+        }
+    #endif
+
+    #endif // KS_GUI_SHM_PLATFORM_AVAILABLE
+
+        // ============================================================= //
+    }
+}
@@ -0,0 +1,312 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_SHM_PLATFORM_HPP
+#define KS_GUI_SHM_PLATFORM_HPP
+
+#include <atomic>
+#include <mutex>
+#include <ks/gui/KsGuiPlatform.hpp>
+
+#if defined(__linux__)
+    #define KS_GUI_SHM_PLATFORM_AVAILABLE 1
+#endif
+
+namespace ks
+{
+    namespace gui
+    {
+        // ============================================================= //
+
+        class ShmFrameReaderError : public ks::Exception
+        {
+        public:
+            ShmFrameReaderError(std::string msg);
+            ~ShmFrameReaderError() = default;
+        };
+
+        // ============================================================= //
+
+        // * The layout at the start of a shared memory
+        //   framebuffer, followed by BufferCount pixel
+        //   buffers at buffer_offset
+        // * Pixels are RGBA8888, rows top to bottom with
+        //   @stride bytes per row
+        // * Frames are numbered from 1; frame N is written to
+        //   buffer N % BufferCount and published by storing N
+        //   in @frame_index (release). While frame N is
+        //   published the producer is rendering frame N+1
+        //   into the other buffer; once N+1 is published
+        //   it starts overwriting frame N.
+        struct ShmFrameHeader final
+        {
+            static u32 const Magic = 0x4653474B; // "KSGF"
+            static u32 const Version = 1;
+            static uint const BufferCount = 2;
+
+            u32 magic;
+            u32 version;
+            u32 max_width;
+            u32 max_height;
+            u32 stride;
+            u32 buffer_count;
+            u64 buffer_size;
+            u64 buffer_offset[BufferCount];
+
+            // * The size of the frame held by each buffer;
+            //   written before the frame is published
+            u32 buffer_width[BufferCount];
+            u32 buffer_height[BufferCount];
+
+            // * The last published frame, 0 if there isn't one
+            std::atomic<u64> frame_index;
+
+            // * Set to 1 when the window is destroyed
+            std::atomic<u32> closed;
+        };
+
+        static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+                      "ShmFrameHeader: Shared memory atomics must be lock free");
+
+        // * A CPU render target
+        struct SoftwareSurface final
+        {
+            u8* data;
+            uint width;
+            uint height;
+            uint stride;
+        };
+
+        // ============================================================= //
+
+    #ifdef KS_GUI_SHM_PLATFORM_AVAILABLE
+
+        // * Maps a shared memory framebuffer in a consumer
+        //   process and reads frames in place
+        // * Usage:
+        //      ShmFrameReader::Frame frame;
+        //      if(reader.AcquireFrame(frame)) {
+        //          ... read frame.surface ...
+        //          if(!reader.ValidateFrame(frame)) {
+        //              // overwritten while reading; retry
+        //          }
+        //      }
+        class ShmFrameReader final
+        {
+        public:
+            struct Frame final
+            {
+                u64 index;
+                SoftwareSurface surface;
+            };
+
+            // * Opens @path, ie. ShmPlatformWindow::GetPath
+            //   from the producer. Throws ShmFrameReaderError
+            //   if it can't be mapped or isn't a framebuffer.
+            ShmFrameReader(std::string const &path);
+            ~ShmFrameReader();
+
+            ShmFrameReader(ShmFrameReader const &) = delete;
+            ShmFrameReader& operator=(ShmFrameReader const &) = delete;
+
+            // * The last published frame, 0 if none
+            u64 GetFrameIndex() const;
+
+            bool GetClosed() const;
+
+            // * Points @frame at the last published frame
+            // * Returns false if nothing has been published
+            bool AcquireFrame(Frame &frame) const;
+
+            // * Returns true if @frame wasn't overwritten since
+            //   it was acquired; call after reading it
+            bool ValidateFrame(Frame const &frame) const;
+
+        private:
+            u8* m_mapping;
+            size_t m_mapping_size;
+            ShmFrameHeader const * m_header;
+        };
+
+        // ============================================================= //
+
+        // * A headless platform window whose surface is a
+        //   memfd backed shared memory framebuffer, so other
+        //   local processes can map and read frames without
+        //   copies (see ShmFrameHeader and ShmFrameReader)
+        // * There is no GL context; the app renders into
+        //   GetSurface with its own raster code or a software
+        //   GL bound to that memory
+        // * The framebuffer is sized for the screen on creation
+        //   so resizing never remaps it; window sizes are
+        //   clamped to the screen size
+        class ShmPlatformWindow final : public IPlatformWindow
+        {
+        public:
+            // * Called on the render thread after each frame is
+            //   published; the surface stays valid until the
+            //   callback returns
+            using PresentCallback =
+                std::function<void(ShmPlatformWindow&,
+                                   SoftwareSurface const &,
+                                   u64)>;
+
+            // * @on_notify is called after the window queues
+            //   a notification so the platform can have
+            //   them delivered
+            ShmPlatformWindow(Window::Properties const &win_props,
+                              Screen::Size const &max_size,
+                              Microseconds refresh_period,
+                              std::function<void()> on_notify);
+
+            ~ShmPlatformWindow();
+
+            // * The window whose context is current on the
+            //   calling thread, or nullptr
+            static ShmPlatformWindow* GetCurrent();
+
+            // * The buffer to render the next frame into
+            // * Only valid on the render thread with the
+            //   context current, until SwapBuffers
+            SoftwareSurface GetSurface();
+
+            // * The memfd and a path another process of the
+            //   same user can open to map it
+            int GetFd() const;
+            std::string GetPath() const;
+
+            // * The last published frame
+            u64 GetFrameIndex() const;
+
+            // * Sets @surface to the last published frame, whose
+            //   buffer isn't written again until the render thread
+            //   starts the frame after next. Returns false if no
+            //   frame has been published yet.
+            // * Blocking the present callback therefore keeps the
+            //   buffer stable (see RemotePlatform)
+            bool GetPresentedSurface(SoftwareSurface &surface,
+                                     u64 &frame_index) const;
+
+            // * Must be set before rendering starts
+            void SetPresentCallback(PresentCallback callback);
+
+            // IPlatformWindow
+            bool IsCurrentContext() override;
+            void MakeContextCurrent() override;
+            void ReleaseContext() override;
+            void SwapBuffers() override;
+            void SetContextSwapInterval(uint swap_interval) override;
+            bool GetHasGLContext() const override;
+            bool GetHasContextSwapInterval() const override;
+
+            void SetSize(Window::Size const &size) override;
+            void SetPosition(Window::Position const &position) override;
+            void SetFullscreen(Window::FullscreenMode fullscreen) override;
+            void SetFocused(bool focused) override;
+            void SetVisible(bool visible) override;
+            void SetAlwaysOnTop(bool always_on_top) override;
+            void SetSwapInterval(uint swap_interval) override;
+            void SetTitle(std::string const &title) override;
+            void Destroy() override;
+
+        private:
+            Window::Size clampSize(Window::Size size) const;
+            void beginFrame();
+
+            Screen::Size const m_max_size;
+            Microseconds const m_refresh_period;
+            std::function<void()> m_on_notify;
+            PresentCallback m_present_callback;
+
+            int m_fd;
+            u8* m_mapping;
+            size_t m_mapping_size;
+            ShmFrameHeader* m_header;
+
+            // * Set on the app thread, read by the render
+            //   thread at the start of each frame
+            std::mutex m_mutex;
+            Window::Size m_size;
+            Window::Size m_windowed_size;
+            Window::FullscreenMode m_fullscreen;
+
+            std::atomic<uint> m_context_swap_interval;
+
+            // * Render thread only
+            Window::Size m_frame_size;
+            TimePoint m_last_swap;
+            bool m_frame_begun;
+        };
+
+        // ============================================================= //
+
+        // * Runs the application without a display; windows
+        //   are ShmPlatformWindows on a virtual screen
+        // * There is no input; Run blocks in the app EventLoop
+        //   until Quit
+        class ShmPlatform : public IPlatform
+        {
+        public:
+            static uint const DefaultScreenWidth = 1920;
+            static uint const DefaultScreenHeight = 1080;
+
+            ShmPlatform(shared_ptr<EventLoop> app_event_loop,
+                        Screen::Size screen_size,
+                        Microseconds refresh_period);
+
+            virtual ~ShmPlatform() = default;
+
+            void ProcessEvents() override;
+            void Run() override;
+            void Quit() override;
+
+            // * There are no platform events to poll for; the
+            //   waiter is woken when a window notifies
+            bool WaitEvents(EventWaiter& waiter,
+                            Milliseconds timeout) override;
+
+            std::vector<shared_ptr<Screen const>> GetScreens() override;
+
+            shared_ptr<IPlatformWindow>
+            CreateWindow(shared_ptr<EventLoop>& window_evl,
+                         Window::Attributes& win_attrs,
+                         Window::Properties& win_props) override;
+
+            void DestroyWindow(shared_ptr<IPlatformWindow> platform_window) override;
+
+        protected:
+            shared_ptr<EventLoop> const & GetAppEventLoop() const;
+
+        private:
+            void onWindowNotify();
+
+            shared_ptr<EventLoop> m_app_event_loop;
+            Screen::Size const m_screen_size;
+            Microseconds const m_refresh_period;
+            shared_ptr<Screen const> m_screen;
+
+            // * Set while a task to deliver window
+            //   notifications is queued
+            shared_ptr<std::atomic<bool>> m_notify_pending;
+        };
+
+    #endif // KS_GUI_SHM_PLATFORM_AVAILABLE
+
+        // ============================================================= //
+    }
+}
+
+#endif // KS_GUI_SHM_PLATFORM_HPP
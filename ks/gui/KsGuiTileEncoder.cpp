@@ -0,0 +1,347 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <ks/gui/KsGuiTileEncoder.hpp>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define KS_GUI_TILE_HASH_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define KS_GUI_TILE_HASH_NEON 1
+#endif
+
+namespace ks
+{
+    namespace gui
+    {
+        namespace {
+            // * Each 16 byte block is xor'd into two 64 bit lanes
+            //   that are then mixed with 32x32->64 multiplies,
+            //   which SSE2 (pmuludq) and NEON (vmull) both have,
+            //   so every path computes the same hash
+            u32 const g_k1 = 0x9E3779B1;
+            u32 const g_k2 = 0x85EBCA77;
+
+            inline u64 MixScalar(u64 state, u64 value)
+            {
+                u64 const x = state ^ value;
+                return ((x & 0xFFFFFFFF)*g_k1)+((x >> 32)*g_k2);
+            }
+
+            inline u64 Finalize(u64 h)
+            {
+                h ^= h >> 33;
+                h *= 0xFF51AFD7ED558CCDULL;
+                h ^= h >> 33;
+                h *= 0xC4CEB9FE1A85EC53ULL;
+                h ^= h >> 33;
+                return h;
+            }
+
+            template<typename T>
+            void Write(std::vector<u8> &buffer, T value)
+            {
+                size_t const offset = buffer.size();
+                buffer.resize(offset+sizeof(T));
+                std::memcpy(&buffer[offset],&value,sizeof(T));
+            }
+        }
+
+        // ============================================================= //
+
+        uint const TileEncoder::TileSize;
+
+        TileEncoder::TileEncoder() :
+            m_width(0),
+            m_height(0),
+            m_stats{0,0,0,0}
+        {}
+
+        u64 TileEncoder::HashTile(u8 const * data,
+                                  uint stride,
+                                  uint width,
+                                  uint height)
+        {
+        #if defined(KS_GUI_TILE_HASH_SSE2) || defined(KS_GUI_TILE_HASH_NEON)
+            uint const row_bytes = width*4;
+            uint const blocks = row_bytes/16;
+            uint const tail = row_bytes%16;
+
+            u64 list_lanes[2] = {
+                0x27D4EB2F165667C5ULL ^ width,
+                0x165667B19E3779F9ULL ^ height
+            };
+
+        #if defined(KS_GUI_TILE_HASH_SSE2)
+            __m128i const k1 = _mm_set1_epi32(static_cast<int>(g_k1));
+            __m128i const k2 = _mm_set1_epi32(static_cast<int>(g_k2));
+            __m128i state = _mm_loadu_si128(
+                        reinterpret_cast<__m128i const *>(list_lanes));
+        #else
+            uint32x2_t const k1 = vdup_n_u32(g_k1);
+            uint32x2_t const k2 = vdup_n_u32(g_k2);
+            uint64x2_t state = vld1q_u64(list_lanes);
+        #endif
+
+            for(uint y=0; y < height; y++)
+            {
+                u8 const * row = data+(size_t(y)*stride);
+
+            #if defined(KS_GUI_TILE_HASH_SSE2)
+                for(uint i=0; i < blocks; i++) {
+                    __m128i const x =
+                            _mm_xor_si128(
+                                state,
+                                _mm_loadu_si128(
+                                    reinterpret_cast<__m128i const *>(row+(i*16))));
+
+                    state = _mm_add_epi64(
+                                _mm_mul_epu32(x,k1),
+                                _mm_mul_epu32(_mm_srli_epi64(x,32),k2));
+                }
+            #else
+                for(uint i=0; i < blocks; i++) {
+                    uint64x2_t const x =
+                            veorq_u64(
+                                state,
+                                vreinterpretq_u64_u8(vld1q_u8(row+(i*16))));
+
+                    state = vmlal_u32(
+                                vmull_u32(vmovn_u64(x),k1),
+                                vshrn_n_u64(x,32),k2);
+                }
+            #endif
+
+                if(tail > 0)
+                {
+                    // Zero pad the rest of the row
+                    u64 list_values[2] = {0,0};
+                    std::memcpy(list_values,row+(blocks*16),tail);
+
+                #if defined(KS_GUI_TILE_HASH_SSE2)
+                    __m128i const x =
+                            _mm_xor_si128(
+                                state,
+                                _mm_loadu_si128(
+                                    reinterpret_cast<__m128i const *>(list_values)));
+
+                    state = _mm_add_epi64(
+                                _mm_mul_epu32(x,k1),
+                                _mm_mul_epu32(_mm_srli_epi64(x,32),k2));
+                #else
+                    uint64x2_t const x = veorq_u64(state,vld1q_u64(list_values));
+                    state = vmlal_u32(
+                                vmull_u32(vmovn_u64(x),k1),
+                                vshrn_n_u64(x,32),k2);
+                #endif
+                }
+            }
+
+        #if defined(KS_GUI_TILE_HASH_SSE2)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(list_lanes),state);
+        #else
+            vst1q_u64(list_lanes,state);
+        #endif
+
+            return Finalize(list_lanes[0]^
+                            ((list_lanes[1] << 31)|(list_lanes[1] >> 33)));
+        #else
+            return HashTileScalar(data,stride,width,height);
+        #endif
+        }
+
+        u64 TileEncoder::HashTileScalar(u8 const * data,
+                                        uint stride,
+                                        uint width,
+                                        uint height)
+        {
+            uint const row_bytes = width*4;
+            uint const blocks = row_bytes/16;
+            uint const tail = row_bytes%16;
+
+            u64 list_lanes[2] = {
+                0x27D4EB2F165667C5ULL ^ width,
+                0x165667B19E3779F9ULL ^ height
+            };
+
+            for(uint y=0; y < height; y++)
+            {
+                u8 const * row = data+(size_t(y)*stride);
+
+                for(uint i=0; i < blocks; i++) {
+                    u64 list_values[2];
+                    std::memcpy(list_values,row+(i*16),16);
+                    list_lanes[0] = MixScalar(list_lanes[0],list_values[0]);
+                    list_lanes[1] = MixScalar(list_lanes[1],list_values[1]);
+                }
+
+                if(tail > 0) {
+                    // Zero pad the rest of the row
+                    u64 list_values[2] = {0,0};
+                    std::memcpy(list_values,row+(blocks*16),tail);
+                    list_lanes[0] = MixScalar(list_lanes[0],list_values[0]);
+                    list_lanes[1] = MixScalar(list_lanes[1],list_values[1]);
+                }
+            }
+
+            return Finalize(list_lanes[0]^
+                            ((list_lanes[1] << 31)|(list_lanes[1] >> 33)));
+        }
+
+        void TileEncoder::Reset()
+        {
+            // Forces a size change on the next Encode
+            m_width = 0;
+            m_height = 0;
+        }
+
+        uint TileEncoder::Encode(SoftwareSurface const &surface,
+                                 std::vector<u8> &buffer)
+        {
+            uint const columns = (surface.width+TileSize-1)/TileSize;
+            uint const rows = (surface.height+TileSize-1)/TileSize;
+
+            bool const resized =
+                    (surface.width != m_width || surface.height != m_height);
+
+            if(resized) {
+                m_width = surface.width;
+                m_height = surface.height;
+                m_list_hashes.assign(size_t(columns)*rows,0);
+            }
+
+            size_t const start_size = buffer.size();
+            uint tiles = 0;
+
+            for(uint row=0; row < rows; row++)
+            {
+                uint const y = row*TileSize;
+                uint const height = std::min(TileSize,surface.height-y);
+
+                for(uint column=0; column < columns; column++)
+                {
+                    uint const x = column*TileSize;
+                    uint const width = std::min(TileSize,surface.width-x);
+
+                    u8 const * data =
+                            surface.data+(size_t(y)*surface.stride)+(x*4);
+
+                    u64 const hash = HashTile(data,surface.stride,width,height);
+                    u64& prev_hash = m_list_hashes[(size_t(row)*columns)+column];
+
+                    if(resized || hash != prev_hash) {
+                        prev_hash = hash;
+                        encodeTile(data,surface.stride,column,row,
+                                   width,height,buffer);
+                        tiles++;
+                    }
+                }
+            }
+
+            m_stats.frames++;
+            m_stats.tiles_hashed += size_t(columns)*rows;
+            m_stats.tiles_sent += tiles;
+            m_stats.bytes += buffer.size()-start_size;
+
+            return tiles;
+        }
+
+        TileEncoder::Stats const & TileEncoder::GetStats() const
+        {
+            return m_stats;
+        }
+
+        void TileEncoder::encodeTile(u8 const * data,
+                                     uint stride,
+                                     uint tile_x,
+                                     uint tile_y,
+                                     uint width,
+                                     uint height,
+                                     std::vector<u8> &buffer)
+        {
+            // Run length encode the tile, giving up once
+            // it's no smaller than the raw pixels
+            size_t const raw_size = size_t(width)*height*4;
+            size_t const run_size = sizeof(u32)+sizeof(u16);
+
+            m_rle_buffer.clear();
+
+            u32 run_pixel;
+            std::memcpy(&run_pixel,data,4);
+            u16 run_count = 0;
+            uint runs = 0;
+            bool use_rle = true;
+
+            for(uint y=0; use_rle && y < height; y++) {
+                u8 const * row = data+(size_t(y)*stride);
+                for(uint x=0; x < width; x++) {
+                    u32 pixel;
+                    std::memcpy(&pixel,row+(x*4),4);
+
+                    if(pixel == run_pixel) {
+                        run_count++;
+                        continue;
+                    }
+
+                    Write<u32>(m_rle_buffer,run_pixel);
+                    Write<u16>(m_rle_buffer,run_count);
+                    runs++;
+
+                    if(m_rle_buffer.size()+run_size >= raw_size) {
+                        use_rle = false;
+                        break;
+                    }
+
+                    run_pixel = pixel;
+                    run_count = 1;
+                }
+            }
+
+            Write<u16>(buffer,static_cast<u16>(tile_x));
+            Write<u16>(buffer,static_cast<u16>(tile_y));
+
+            if(use_rle && runs == 0) {
+                Write<u8>(buffer,static_cast<u8>(Encoding::Solid));
+                Write<u32>(buffer,sizeof(u32));
+                Write<u32>(buffer,run_pixel);
+            }
+            else if(use_rle) {
+                Write<u32>(m_rle_buffer,run_pixel);
+                Write<u16>(m_rle_buffer,run_count);
+
+                Write<u8>(buffer,static_cast<u8>(Encoding::Rle));
+                Write<u32>(buffer,static_cast<u32>(m_rle_buffer.size()));
+                buffer.insert(buffer.end(),m_rle_buffer.begin(),m_rle_buffer.end());
+            }
+            else {
+                Write<u8>(buffer,static_cast<u8>(Encoding::Raw));
+                Write<u32>(buffer,static_cast<u32>(raw_size));
+
+                size_t offset = buffer.size();
+                buffer.resize(offset+raw_size);
+                for(uint y=0; y < height; y++) {
+                    std::memcpy(&buffer[offset],data+(size_t(y)*stride),width*4);
+                    offset += width*4;
+                }
+            }
+        }
+
+        // ============================================================= //
+    }
+}
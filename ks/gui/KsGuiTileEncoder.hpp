@@ -0,0 +1,114 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_TILE_ENCODER_HPP
+#define KS_GUI_TILE_ENCODER_HPP
+
+#include <vector>
+#include <ks/gui/KsGuiShmPlatform.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        // ============================================================= //
+
+        // * Encodes the tiles of a SoftwareSurface that changed
+        //   since the previous frame
+        // * Every tile is hashed each frame (vectorized, so at
+        //   close to memory bandwidth); only tiles whose hash
+        //   changed are encoded, so the encoding cost and the
+        //   output size scale with the changed area
+        // * Tiles are written as:
+        //      u16 tile column
+        //      u16 tile row
+        //      u8  Encoding
+        //      u32 data size in bytes
+        //      data:
+        //        Solid: u32 pixel
+        //        Rle:   (u32 pixel, u16 count) runs, row major
+        //        Raw:   width*height u32 pixels, row major
+        //   All values are little endian
+        class TileEncoder final
+        {
+        public:
+            static uint const TileSize = 64;
+
+            enum class Encoding : u8
+            {
+                Solid,
+                Rle,
+                Raw
+            };
+
+            struct Stats final
+            {
+                u64 frames;
+                u64 tiles_hashed;
+                u64 tiles_sent;
+                u64 bytes;
+            };
+
+            TileEncoder();
+
+            // * Hashes a @width x @height block of RGBA pixels
+            //   with @stride bytes per row
+            static u64 HashTile(u8 const * data,
+                                uint stride,
+                                uint width,
+                                uint height);
+
+            // * The portable version of HashTile, which every
+            //   vectorized path must match exactly
+            static u64 HashTileScalar(u8 const * data,
+                                      uint stride,
+                                      uint width,
+                                      uint height);
+
+            // * Makes the next Encode write every tile (ie.
+            //   for a new client)
+            void Reset();
+
+            // * Appends the tiles of @surface that changed
+            //   since the last call to @buffer
+            // * Every tile is written if the surface size changed
+            // * Returns the number of tiles written
+            uint Encode(SoftwareSurface const &surface,
+                        std::vector<u8> &buffer);
+
+            Stats const & GetStats() const;
+
+        private:
+            void encodeTile(u8 const * data,
+                            uint stride,
+                            uint tile_x,
+                            uint tile_y,
+                            uint width,
+                            uint height,
+                            std::vector<u8> &buffer);
+
+            uint m_width;
+            uint m_height;
+            std::vector<u64> m_list_hashes;
+            std::vector<u8> m_rle_buffer;
+            Stats m_stats;
+        };
+
+        // ============================================================= //
+    }
+}
+
+#endif // KS_GUI_TILE_ENCODER_HPP
@@ -0,0 +1,250 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <ks/gui/KsGuiTrace.hpp>
+#include <mutex>
+#include <vector>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+
+namespace ks
+{
+    namespace gui
+    {
+        namespace {
+            struct Span
+            {
+                char const * name;
+                Id window_id;
+                s64 begin_ns;
+                s64 duration_ns;
+            };
+
+            // * Written only by its own thread; the write
+            //   count is published so that other threads can
+            //   read the spans it covers
+            struct ThreadBuffer
+            {
+                uint tid;
+                std::atomic<u64> write_count;
+                std::atomic<u64> read_start;
+                Span list_spans[Trace::BufferSize];
+            };
+
+            struct Registry
+            {
+                Registry() :
+                    epoch(std::chrono::steady_clock::now())
+                {}
+
+                TimePoint const epoch;
+
+                // * Only locked when a thread records its first
+                //   span and when exporting
+                std::mutex mutex;
+                std::vector<shared_ptr<ThreadBuffer>> list_buffers;
+            };
+
+            Registry& GetRegistry()
+            {
+                static Registry registry;
+                return registry;
+            }
+
+            // * Buffers are kept by the registry after their
+            //   threads exit so their spans can still be exported
+            thread_local ThreadBuffer* t_buffer = nullptr;
+
+            ThreadBuffer* GetThreadBuffer()
+            {
+                if(t_buffer == nullptr) {
+                    Registry& registry = GetRegistry();
+                    std::lock_guard<std::mutex> lock(registry.mutex);
+
+                    auto buffer = make_shared<ThreadBuffer>();
+                    buffer->tid = static_cast<uint>(registry.list_buffers.size()+1);
+                    buffer->write_count = 0;
+                    buffer->read_start = 0;
+
+                    registry.list_buffers.push_back(buffer);
+                    t_buffer = buffer.get();
+                }
+
+                return t_buffer;
+            }
+
+            s64 GetNanoseconds(TimePoint::duration duration)
+            {
+                return std::chrono::duration_cast<Nanoseconds>(duration).count();
+            }
+
+            // * Trace event timestamps are in microseconds
+            void WriteMicroseconds(std::ostream &stream, s64 ns)
+            {
+                if(ns < 0) {
+                    ns = 0;
+                }
+
+                stream << (ns/1000) << "."
+                       << std::setw(3) << std::setfill('0') << (ns%1000)
+                       << std::setfill(' ');
+            }
+
+            void WriteString(std::ostream &stream, char const * str)
+            {
+                stream << '"';
+                for(; *str != '\0'; str++) {
+                    char const c = *str;
+                    if(c == '"' || c == '\\') {
+                        stream << '\\' << c;
+                    }
+                    else if(static_cast<unsigned char>(c) < 0x20) {
+                        stream << ' ';
+                    }
+                    else {
+                        stream << c;
+                    }
+                }
+                stream << '"';
+            }
+        }
+
+        // ============================================================= //
+
+        std::atomic<bool> Trace::s_enabled(false);
+
+        void Trace::SetEnabled(bool enabled)
+        {
+            // Fix the epoch before any spans are recorded
+            GetRegistry();
+            s_enabled.store(enabled,std::memory_order_relaxed);
+        }
+
+        void Trace::Record(char const * name,
+                           Id window_id,
+                           TimePoint begin,
+                           TimePoint end)
+        {
+            ThreadBuffer* buffer = GetThreadBuffer();
+            TimePoint const epoch = GetRegistry().epoch;
+
+            u64 const index = buffer->write_count.load(std::memory_order_relaxed);
+
+            Span& span = buffer->list_spans[index%BufferSize];
+            span.name = name;
+            span.window_id = window_id;
+            span.begin_ns = GetNanoseconds(begin-epoch);
+            span.duration_ns = GetNanoseconds(end-begin);
+
+            buffer->write_count.store(index+1,std::memory_order_release);
+        }
+
+        void Trace::Clear()
+        {
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+
+            for(auto& buffer : registry.list_buffers) {
+                buffer->read_start.store(
+                            buffer->write_count.load(std::memory_order_acquire),
+                            std::memory_order_relaxed);
+            }
+        }
+
+        void Trace::WriteJson(std::ostream &stream)
+        {
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+
+            stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+            bool first = true;
+
+            std::vector<Span> list_spans;
+
+            for(auto& buffer : registry.list_buffers)
+            {
+                // Name the thread
+                stream << (first ? "" : ",")
+                       << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                       << "\"tid\":" << buffer->tid << ","
+                       << "\"args\":{\"name\":\"thread " << buffer->tid << "\"}}";
+                first = false;
+
+                // Copy out the spans still in the ring
+                u64 const end = buffer->write_count.load(std::memory_order_acquire);
+                u64 begin = buffer->read_start.load(std::memory_order_relaxed);
+                if(end > BufferSize) {
+                    begin = std::max(begin,end-BufferSize);
+                }
+
+                list_spans.clear();
+                for(u64 i=begin; i < end; i++) {
+                    list_spans.push_back(buffer->list_spans[i%BufferSize]);
+                }
+
+                // Drop any spans the owning thread overwrote
+                // while they were being copied, including the
+                // slot of a write that may still be in progress
+                std::atomic_thread_fence(std::memory_order_acquire);
+                u64 const end_after =
+                        buffer->write_count.load(std::memory_order_relaxed)+1;
+
+                uint skip = 0;
+                if(end_after > BufferSize && end_after-BufferSize > begin) {
+                    skip = static_cast<uint>(
+                                std::min<u64>(end_after-BufferSize-begin,
+                                              list_spans.size()));
+                }
+
+                for(uint i=skip; i < list_spans.size(); i++) {
+                    Span const &span = list_spans[i];
+
+                    stream << ",\n{\"name\":";
+                    WriteString(stream,span.name);
+                    stream << ",\"cat\":\"ks_gui\",\"ph\":\"X\",\"pid\":1,"
+                           << "\"tid\":" << buffer->tid << ",\"ts\":";
+                    WriteMicroseconds(stream,span.begin_ns);
+                    stream << ",\"dur\":";
+                    WriteMicroseconds(stream,span.duration_ns);
+
+                    if(span.window_id != 0) {
+                        stream << ",\"args\":{\"window\":" << span.window_id << "}";
+                    }
+
+                    stream << "}";
+                }
+            }
+
+            stream << "\n]}\n";
+        }
+
+        bool Trace::WriteJsonFile(std::string const &path)
+        {
+            std::ofstream file(path,std::ios::out|std::ios::trunc);
+            if(!file) {
+                return false;
+            }
+
+            WriteJson(file);
+            file.flush();
+
+            return file.good();
+        }
+
+        // ============================================================= //
+    }
+}
@@ -0,0 +1,129 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_TRACE_HPP
+#define KS_GUI_TRACE_HPP
+
+#include <atomic>
+#include <ostream>
+#include <ks/KsGlobal.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        // ============================================================= //
+
+        // * Records timed spans into per thread ring buffers
+        //   that can be exported in the Chrome trace event
+        //   format (chrome://tracing, ui.perfetto.dev)
+        // * Recording is disabled by default; while disabled
+        //   a span costs a single relaxed atomic load
+        // * Each thread only writes to its own buffer so
+        //   recording never takes a lock. Once a buffer is
+        //   full the oldest spans are overwritten.
+        class Trace final
+        {
+        public:
+            // * Spans kept per thread
+            static uint const BufferSize = 16384;
+
+            // * Thread safe
+            static void SetEnabled(bool enabled);
+
+            static bool GetEnabled()
+            {
+                return s_enabled.load(std::memory_order_relaxed);
+            }
+
+            // * Records a completed span
+            // * @name must outlive the trace (ie. a string
+            //   literal); only the pointer is stored
+            static void Record(char const * name,
+                               Id window_id,
+                               TimePoint begin,
+                               TimePoint end);
+
+            // * Discards all recorded spans
+            // * Thread safe, but spans recorded at the same
+            //   time may be lost
+            static void Clear();
+
+            // * Writes all recorded spans as trace event JSON
+            // * Thread safe. Spans that are overwritten while
+            //   writing are skipped; disable recording first
+            //   for a consistent snapshot.
+            static void WriteJson(std::ostream &stream);
+
+            // * Writes the JSON to the file at @path
+            // * Returns false if the file couldn't be written
+            static bool WriteJsonFile(std::string const &path);
+
+        private:
+            static std::atomic<bool> s_enabled;
+        };
+
+        // ============================================================= //
+
+        // * Records a span from construction to destruction
+        //   if tracing was enabled on construction
+        class TraceScope final
+        {
+        public:
+            TraceScope(char const * name, Id window_id=0) :
+                m_name(Trace::GetEnabled() ? name : nullptr),
+                m_window_id(window_id)
+            {
+                if(m_name) {
+                    m_begin = std::chrono::steady_clock::now();
+                }
+            }
+
+            ~TraceScope()
+            {
+                if(m_name) {
+                    Trace::Record(m_name,
+                                  m_window_id,
+                                  m_begin,
+                                  std::chrono::steady_clock::now());
+                }
+            }
+
+            TraceScope(TraceScope const &) = delete;
+            TraceScope& operator=(TraceScope const &) = delete;
+
+        private:
+            char const * const m_name;
+            Id const m_window_id;
+            TimePoint m_begin;
+        };
+
+        // ============================================================= //
+    }
+}
+
+// * Traces the rest of the enclosing scope
+// * Define KS_GUI_DISABLE_TRACE to compile out all spans
+#ifdef KS_GUI_DISABLE_TRACE
+    #define KS_GUI_TRACE_SCOPE(name,window_id)
+#else
+    #define KS_GUI_TRACE_CONCAT_IMPL(a,b) a##b
+    #define KS_GUI_TRACE_CONCAT(a,b) KS_GUI_TRACE_CONCAT_IMPL(a,b)
+    #define KS_GUI_TRACE_SCOPE(name,window_id) \
+        ks::gui::TraceScope KS_GUI_TRACE_CONCAT(ks_gui_trace_scope_,__LINE__)(name,window_id)
+#endif
+
+#endif // KS_GUI_TRACE_HPP
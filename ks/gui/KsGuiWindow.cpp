@@ -16,7 +16,11 @@
 
 #include <ks/gui/KsGuiWindow.hpp>
 #include <ks/gui/KsGuiApplication.hpp>
+#include <ks/gui/KsGuiWindowChannel.hpp>
+#include <ks/gui/KsGuiPlatformDispatch.hpp>
+#include <ks/gui/KsGuiTrace.hpp>
 #include <ks/KsTimer.hpp>
+#include <cmath>
 
 namespace ks
 {
@@ -34,6 +38,169 @@ namespace ks
 
         // ============================================================= //
 
+        RenderContext::RenderContext() :
+            m_window(nullptr),
+            m_generation(0)
+        {}
+
+        RenderContext::RenderContext(Window* window, u32 generation) :
+            m_window(window),
+            m_generation(generation)
+        {}
+
+        bool RenderContext::IsValid() const
+        {
+            return (m_window &&
+                    m_window->m_render_generation.load(
+                        std::memory_order_acquire) == m_generation);
+        }
+
+        bool RenderContext::MakeCurrent()
+        {
+            if(!IsValid()) {
+                return false;
+            }
+
+            m_window->setContextCurrent();
+            return true;
+        }
+
+        bool RenderContext::SwapBuffers()
+        {
+            if(!IsValid()) {
+                return false;
+            }
+
+            m_window->swapBuffers();
+            return true;
+        }
+
+        bool RenderContext::SetSwapInterval(uint swap_interval)
+        {
+            if(!IsValid()) {
+                return false;
+            }
+
+            if(!m_window->m_platform_window->GetHasContextSwapInterval()) {
+                return false;
+            }
+
+            PlatformWindowDispatch::SetContextSwapInterval(
+                        m_window->m_platform_window,swap_interval);
+
+            return true;
+        }
+
+        u32 RenderContext::GetContextGeneration() const
+        {
+            if(!IsValid()) {
+                return 0;
+            }
+
+            return m_window->m_context_generation.load(std::memory_order_acquire);
+        }
+
+        std::pair<uint,uint> RenderContext::GetSurfaceSize() const
+        {
+            if(!IsValid()) {
+                return std::pair<uint,uint>(0,0);
+            }
+
+            return m_window->size.Get();
+        }
+
+        // ============================================================= //
+
+        Window::PropertyChanges::PropertyChanges() :
+            flags(0),
+            size(0,0),
+            position(0,0),
+            fullscreen(FullscreenMode::None),
+            focused(false),
+            visible(false),
+            always_on_top(false),
+            swap_interval(0)
+        {}
+
+        Window::PropertyChanges& Window::PropertyChanges::SetSize(Size new_size)
+        {
+            flags |= SIZE;
+            size = new_size;
+            return *this;
+        }
+
+        Window::PropertyChanges& Window::PropertyChanges::SetPosition(Position new_position)
+        {
+            flags |= POSITION;
+            position = new_position;
+            return *this;
+        }
+
+        Window::PropertyChanges& Window::PropertyChanges::SetFullscreen(FullscreenMode new_fullscreen)
+        {
+            flags |= FULLSCREEN;
+            fullscreen = new_fullscreen;
+            return *this;
+        }
+
+        Window::PropertyChanges& Window::PropertyChanges::SetFocused(bool new_focused)
+        {
+            flags |= FOCUSED;
+            focused = new_focused;
+            return *this;
+        }
+
+        Window::PropertyChanges& Window::PropertyChanges::SetVisible(bool new_visible)
+        {
+            flags |= VISIBLE;
+            visible = new_visible;
+            return *this;
+        }
+
+        Window::PropertyChanges& Window::PropertyChanges::SetAlwaysOnTop(bool new_always_on_top)
+        {
+            flags |= ALWAYS_ON_TOP;
+            always_on_top = new_always_on_top;
+            return *this;
+        }
+
+        Window::PropertyChanges& Window::PropertyChanges::SetSwapInterval(uint new_swap_interval)
+        {
+            flags |= SWAP_INTERVAL;
+            swap_interval = new_swap_interval;
+            return *this;
+        }
+
+        Window::PropertyChanges& Window::PropertyChanges::SetTitle(std::string new_title)
+        {
+            flags |= TITLE;
+            title = std::move(new_title);
+            return *this;
+        }
+
+        bool Window::PropertyChanges::GetHas(u16 flag) const
+        {
+            return ((flags & flag) != 0);
+        }
+
+        void Window::PropertyChanges::Merge(PropertyChanges const &older)
+        {
+            u16 const missing = older.flags & static_cast<u16>(~flags);
+
+            if(missing & SIZE) { size = older.size; }
+            if(missing & POSITION) { position = older.position; }
+            if(missing & FULLSCREEN) { fullscreen = older.fullscreen; }
+            if(missing & FOCUSED) { focused = older.focused; }
+            if(missing & VISIBLE) { visible = older.visible; }
+            if(missing & ALWAYS_ON_TOP) { always_on_top = older.always_on_top; }
+            if(missing & SWAP_INTERVAL) { swap_interval = older.swap_interval; }
+            if(missing & TITLE) { title = older.title; }
+
+            flags |= missing;
+        }
+
+        // ============================================================= //
+
         Window::Window(ks::Object::Key const &key,
                        shared_ptr<EventLoop> event_loop,
                        Attributes const &attributes,
@@ -49,13 +216,138 @@ namespace ks
             title(p.title),
             m_attributes(attributes),
             m_closed(false),
-            m_block_rendering(true)
-        {}
+            m_block_rendering(true),
+            m_notify_coalescing(false),
+            m_notify_flush_queued(false),
+            m_pending_size{false,Size(p.width,p.height)},
+            m_pending_position{false,Position(p.x,p.y)},
+            m_notify_received(0),
+            m_notify_delivered(0),
+            m_notify_collapsed(0),
+            m_live_resize(false),
+            m_frame_requested(false),
+            m_ready(false),
+            m_governor_enabled(false),
+            m_governor_dirty(false),
+            m_governor_scheduled(false),
+            m_governor_animations(0),
+            m_governor_timer_interval(0),
+            m_governor_idle_start(std::chrono::steady_clock::now()),
+            m_command_channel(make_shared<WindowCommandChannel>()),
+            m_notify_inbox(make_shared<WindowNotifyInbox>()),
+            m_platform_window(nullptr),
+            m_has_gl_context(true),
+            m_render_generation(0),
+            m_context_generation(0)
+        {
+            m_governor_stats.state = FrameGovernorState::Idle;
+            m_governor_stats.frames = 0;
+            m_governor_stats.idle_time = Microseconds(0);
+        }
 
         void Window::Init(ks::Object::Key const &,
-                          shared_ptr<Window> const &)
+                          shared_ptr<Window> const &this_win)
         {
+            m_metrics = Metrics::RegisterWindow(this->GetId());
 
+            // Window ---> PlatformWindow
+            size.signal_set.Connect(
+                        this_win,
+                        &Window::onSizeSet,
+                        ks::ConnectionType::Direct);
+
+            position.signal_set.Connect(
+                        this_win,
+                        &Window::onPositionSet,
+                        ks::ConnectionType::Direct);
+
+            fullscreen.signal_set.Connect(
+                        this_win,
+                        &Window::onFullscreenSet,
+                        ks::ConnectionType::Direct);
+
+            // PlatformWindow ---> Window
+            signal_notify_size.Connect(
+                        &size,
+                        &DeferredProperty<Size>::Notify,
+                        this_win);
+
+            signal_notify_position.Connect(
+                        &position,
+                        &DeferredProperty<Position>::Notify,
+                        this_win);
+
+            signal_flush_notifications.Connect(
+                        this_win,
+                        &Window::FlushNotifications,
+                        ks::ConnectionType::Queued);
+
+            size.signal_changed.Connect(
+                        this_win,
+                        &Window::onSizeChanged,
+                        ks::ConnectionType::Direct);
+
+            focused.signal_changed.Connect(
+                        this_win,
+                        &Window::onFocusedChanged,
+                        ks::ConnectionType::Direct);
+
+            visible.signal_changed.Connect(
+                        this_win,
+                        &Window::onVisibleChanged,
+                        ks::ConnectionType::Direct);
+
+            // Only a weak reference so that a queued frame
+            // doesn't keep the Window alive
+            weak_ptr<Window> weak_win = this_win;
+            m_frame_task =
+                    make_shared<Task>(
+                        [weak_win](){
+                            if(auto win = weak_win.lock()) {
+                                win->onFrameRequested();
+                            }
+                        });
+
+            m_notify_task =
+                    make_shared<Task>(
+                        [weak_win](){
+                            if(auto win = weak_win.lock()) {
+                                win->onNotifyTask();
+                            }
+                        });
+
+            // The Application only pushes notifications while
+            // it holds a reference to this Window
+            m_notify_inbox->channel.SetPendingCallback(
+                        [this](){
+                            this->GetEventLoop()->PostTask(m_notify_task);
+                        });
+
+            // Application ---> Window
+            signal_app_keyboard_input.Connect(
+                        this_win,
+                        &Window::onAppKeyboardInput,
+                        ks::ConnectionType::Queued);
+
+            signal_app_text_input.Connect(
+                        this_win,
+                        &Window::onAppTextInput,
+                        ks::ConnectionType::Queued);
+
+            signal_app_mouse_input.Connect(
+                        this_win,
+                        &Window::onAppMouseInput,
+                        ks::ConnectionType::Queued);
+
+            signal_app_touch_input.Connect(
+                        this_win,
+                        &Window::onAppTouchInput,
+                        ks::ConnectionType::Queued);
+
+            signal_app_scroll_input.Connect(
+                        this_win,
+                        &Window::onAppScrollInput,
+                        ks::ConnectionType::Queued);
         }
 
         Window::~Window()
@@ -111,6 +403,8 @@ namespace ks
 
         void Window::InvokeWithContext(std::function<void()> callback)
         {
+            KS_GUI_TRACE_SCOPE("Window::InvokeWithContext",this->GetId());
+
             if(m_block_rendering)
             {
                 return;
@@ -136,44 +430,285 @@ namespace ks
 
         void Window::SwapBuffers()
         {
+            KS_GUI_TRACE_SCOPE("Window::SwapBuffers",this->GetId());
+
             if(m_block_rendering)
             {
+                m_metrics->frames_dropped.fetch_add(1,std::memory_order_relaxed);
                 return;
             }
 
             setContextCurrent();
-            signal_swap_buffers.Emit();
+            swapBuffers();
+        }
+
+        RenderContext Window::AcquireRenderContext()
+        {
+            if(m_block_rendering || m_platform_window == nullptr) {
+                return RenderContext();
+            }
+
+            return RenderContext(
+                        this,
+                        m_render_generation.load(std::memory_order_acquire));
         }
 
         void Window::Close()
         {
+            KS_GUI_TRACE_SCOPE("Window::Close",this->GetId());
+
             if(!m_closed) {
                 m_block_rendering = true;
+                invalidateRenderContexts();
 
-                signal_release_context.Emit();
-                signal_app_close_window.Emit(this->GetId());
+                if(m_live_resize_timer) {
+                    m_live_resize_timer->Stop();
+                }
+
+                if(m_governor_timer) {
+                    m_governor_timer->Stop();
+                }
+
+                releaseContext();
+                m_platform_window = nullptr;
+                m_frame_arena.Clear();
+                Metrics::UnregisterWindow(this->GetId());
+
+                // Keep the binaries built so far for the
+                // next launch
+                if(auto program_cache = GetProgramCache()) {
+                    program_cache->Flush();
+                }
+
+                m_command_channel->PushClose();
                 m_closed = true;
             }
 
             LOG.Trace() << "Window::Close";
         }
 
+        void Window::ApplyProperties(PropertyChanges const &changes)
+        {
+            if(changes.flags == 0) {
+                return;
+            }
+
+            m_command_channel->PushProperties(changes);
+        }
+
+        void Window::SetNotifyCoalescing(bool enabled)
+        {
+            m_notify_coalescing = enabled;
+        }
+
+        void Window::FlushNotifications()
+        {
+            PendingNotify<Size> pending_size;
+            PendingNotify<Position> pending_position;
+
+            {
+                std::lock_guard<std::mutex> lock(m_notify_mutex);
+
+                pending_size = m_pending_size;
+                pending_position = m_pending_position;
+                m_pending_size.valid = false;
+                m_pending_position.valid = false;
+                m_notify_flush_queued = false;
+            }
+
+            if(pending_position.valid) {
+                m_notify_delivered++;
+                position.Notify(pending_position.value);
+            }
+
+            if(pending_size.valid) {
+                m_notify_delivered++;
+                size.Notify(pending_size.value);
+            }
+        }
+
+        Window::NotifyStats Window::GetNotifyStats() const
+        {
+            NotifyStats stats;
+            stats.received = m_notify_received;
+            stats.delivered = m_notify_delivered;
+            stats.collapsed = m_notify_collapsed;
+
+            return stats;
+        }
+
+        void Window::SetLiveResizeConfig(LiveResizeConfig const &config)
+        {
+            m_live_resize_config = config;
+
+            if(m_live_resize_timer) {
+                m_live_resize_timer->Stop();
+                m_live_resize_timer = nullptr;
+            }
+
+            if(m_live_resize) {
+                m_live_resize = false;
+                signal_live_resize.Emit(false);
+            }
+        }
+
+        Window::RenderTarget Window::GetRenderTarget() const
+        {
+            RenderTarget target;
+            target.buffer_size = size.Get();
+            target.viewport_size = size.Get();
+            target.live_resize = m_live_resize;
+
+            if(!m_live_resize) {
+                return target;
+            }
+
+            auto const &config = m_live_resize_config;
+            auto scale_dim = [&config](uint dim) -> uint {
+                uint scaled = static_cast<uint>(std::ceil(dim*config.scale));
+                return (scaled > 0) ? scaled : 1;
+            };
+            auto bucket_dim = [&config](uint dim) -> uint {
+                if(config.bucket_size == 0) {
+                    return dim;
+                }
+                return ((dim+config.bucket_size-1)/config.bucket_size)*config.bucket_size;
+            };
+
+            target.viewport_size.first = scale_dim(target.viewport_size.first);
+            target.viewport_size.second = scale_dim(target.viewport_size.second);
+            target.buffer_size.first = bucket_dim(target.viewport_size.first);
+            target.buffer_size.second = bucket_dim(target.viewport_size.second);
+
+            return target;
+        }
+
+        void Window::SetFrameGovernorConfig(FrameGovernorConfig const &config)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_governor_mutex);
+                m_governor_config = config;
+            }
+
+            m_governor_enabled = config.enabled;
+
+            // Render at least once with the new config
+            Invalidate();
+        }
+
+        void Window::Invalidate()
+        {
+            if(!m_governor_enabled) {
+                return;
+            }
+
+            m_governor_dirty = true;
+            requestGovernorFrame();
+        }
+
+        void Window::RequestFrame()
+        {
+            if(m_governor_enabled) {
+                Invalidate();
+                return;
+            }
+
+            postFrameTask();
+        }
+
+        void Window::BeginAnimation()
+        {
+            m_governor_animations++;
+            Invalidate();
+        }
+
+        void Window::EndAnimation()
+        {
+            uint count = m_governor_animations.load();
+            while(count > 0 &&
+                  !m_governor_animations.compare_exchange_weak(count,count-1))
+            {
+                // count is reloaded on failure
+            }
+        }
+
+        Window::FrameGovernorStats Window::GetFrameGovernorStats() const
+        {
+            std::lock_guard<std::mutex> lock(m_governor_mutex);
+
+            FrameGovernorStats stats = m_governor_stats;
+            if(stats.state == FrameGovernorState::Idle) {
+                stats.idle_time +=
+                        std::chrono::duration_cast<Microseconds>(
+                            std::chrono::steady_clock::now()-
+                            m_governor_idle_start);
+            }
+
+            return stats;
+        }
+
+        void Window::SetMaxFramesInFlight(uint count)
+        {
+            m_frame_pacer.SetMaxFramesInFlight(count);
+        }
+
+        FramePacer::Stats Window::GetFramePacingStats() const
+        {
+            return m_frame_pacer.GetStats();
+        }
+
+        FrameArena& Window::GetFrameArena()
+        {
+            return m_frame_arena;
+        }
+
+        FrameArena::Stats Window::GetFrameArenaStats() const
+        {
+            return m_frame_arena.GetStats();
+        }
+
+        void Window::SetProgramCache(shared_ptr<ProgramCache> cache)
+        {
+            std::lock_guard<std::mutex> lock(m_program_cache_mutex);
+            m_program_cache = std::move(cache);
+        }
+
+        shared_ptr<ProgramCache> Window::GetProgramCache() const
+        {
+            std::lock_guard<std::mutex> lock(m_program_cache_mutex);
+            return m_program_cache;
+        }
+
         void Window::onAppInit()
         {
+            KS_GUI_TRACE_SCOPE("Window::onAppInit",this->GetId());
+
             m_block_rendering = false;
         }
 
         void Window::onAppPause()
         {
+            KS_GUI_TRACE_SCOPE("Window::onAppPause",this->GetId());
+
             m_block_rendering = true;
+            invalidateRenderContexts();
 
             // Required on Android/SDL to recreate the EGL surface
-            signal_release_context.Emit();
+            releaseContext();
+            m_context_generation.fetch_add(1,std::memory_order_release);
         }
 
         void Window::onAppResume()
         {
+            KS_GUI_TRACE_SCOPE("Window::onAppResume",this->GetId());
+
+            // Rendering stays blocked for good once closed
+            if(m_closed) {
+                return;
+            }
+
             m_block_rendering = false;
+            Invalidate();
         }
 
         void Window::onAppQuit()
@@ -183,17 +718,505 @@ namespace ks
 
         void Window::onAppGraphicsReset()
         {
-            // Nothing needs to be done
+            KS_GUI_TRACE_SCOPE("Window::onAppGraphicsReset",this->GetId());
+
+            // Any fences went away with the old context
+            m_frame_pacer.Discard();
+            m_context_generation.fetch_add(1,std::memory_order_release);
+
+            // Let render code rebuild its GL objects
+            signal_graphics_reset.Emit();
+            Invalidate();
         }
 
         void Window::onWindowReady()
         {
+            KS_GUI_TRACE_SCOPE("Window::onWindowReady",this->GetId());
+
             m_block_rendering = false;
+            Invalidate();
+        }
+
+        void Window::onAppKeyboardInput(KeyEvent event)
+        {
+            KS_GUI_TRACE_SCOPE("Window::onAppKeyboardInput",this->GetId());
+
+            m_metrics->pending_input.fetch_sub(1,std::memory_order_relaxed);
+            Invalidate();
+            signal_keyboard_input.Emit(event);
+        }
+
+        void Window::onAppTextInput(TextInputEvent event)
+        {
+            KS_GUI_TRACE_SCOPE("Window::onAppTextInput",this->GetId());
+
+            m_metrics->pending_input.fetch_sub(1,std::memory_order_relaxed);
+            Invalidate();
+            signal_text_input.Emit(event);
+        }
+
+        void Window::onAppMouseInput(MouseEvent event)
+        {
+            KS_GUI_TRACE_SCOPE("Window::onAppMouseInput",this->GetId());
+
+            m_metrics->pending_input.fetch_sub(1,std::memory_order_relaxed);
+            Invalidate();
+            signal_mouse_input.Emit(event);
+        }
+
+        void Window::onAppTouchInput(TouchEvent event)
+        {
+            KS_GUI_TRACE_SCOPE("Window::onAppTouchInput",this->GetId());
+
+            m_metrics->pending_input.fetch_sub(1,std::memory_order_relaxed);
+            Invalidate();
+            signal_touch_input.Emit(event);
+        }
+
+        void Window::onAppScrollInput(ScrollEvent event)
+        {
+            KS_GUI_TRACE_SCOPE("Window::onAppScrollInput",this->GetId());
+
+            m_metrics->pending_input.fetch_sub(1,std::memory_order_relaxed);
+            Invalidate();
+            signal_scroll_input.Emit(event);
+        }
+
+        void Window::onSizeSet(Size new_size)
+        {
+            m_command_channel->PushProperties(PropertyChanges().SetSize(new_size));
+        }
+
+        void Window::onPositionSet(Position new_position)
+        {
+            m_command_channel->PushProperties(PropertyChanges().SetPosition(new_position));
+        }
+
+        void Window::onFullscreenSet(FullscreenMode new_fullscreen)
+        {
+            m_command_channel->PushProperties(PropertyChanges().SetFullscreen(new_fullscreen));
+        }
+
+        void Window::onPlatformSizeChanged(Size new_size)
+        {
+            m_notify_received++;
+
+            if(!m_notify_coalescing) {
+                m_notify_delivered++;
+                signal_notify_size.Emit(new_size);
+                return;
+            }
+
+            bool queue_flush = false;
+            {
+                std::lock_guard<std::mutex> lock(m_notify_mutex);
+
+                if(m_pending_size.valid) {
+                    m_notify_collapsed++;
+                }
+
+                m_pending_size.valid = true;
+                m_pending_size.value = new_size;
+
+                queue_flush = !m_notify_flush_queued;
+                m_notify_flush_queued = true;
+            }
+
+            if(queue_flush) {
+                signal_flush_notifications.Emit();
+            }
+        }
+
+        void Window::onPlatformPositionChanged(Position new_position)
+        {
+            m_notify_received++;
+
+            if(!m_notify_coalescing) {
+                m_notify_delivered++;
+                signal_notify_position.Emit(new_position);
+                return;
+            }
+
+            bool queue_flush = false;
+            {
+                std::lock_guard<std::mutex> lock(m_notify_mutex);
+
+                if(m_pending_position.valid) {
+                    m_notify_collapsed++;
+                }
+
+                m_pending_position.valid = true;
+                m_pending_position.value = new_position;
+
+                queue_flush = !m_notify_flush_queued;
+                m_notify_flush_queued = true;
+            }
+
+            if(queue_flush) {
+                signal_flush_notifications.Emit();
+            }
+        }
+
+        void Window::onNotifyTask()
+        {
+            m_notify_inbox->channel.Drain(m_notify_inbox->list_batch);
+
+            if(!m_notify_inbox->list_batch.empty()) {
+                onPlatformNotifications(m_notify_inbox->list_batch);
+            }
+        }
+
+        void Window::onPlatformNotifications(
+                std::vector<WindowNotification> const &list_notifications)
+        {
+            using Type = WindowNotification::Type;
+
+            PropertyChanges changes;
+            bool close = false;
+
+            for(auto const &notification : list_notifications)
+            {
+                switch(notification.type) {
+                    case Type::SizeChanged:
+                        // Notified by onPlatformSizeChanged
+                        changes.SetSize(notification.size);
+                        break;
+
+                    case Type::PositionChanged:
+                        // Notified by onPlatformPositionChanged
+                        changes.SetPosition(notification.position);
+                        break;
+
+                    case Type::FullscreenChanged:
+                        fullscreen.Notify(notification.fullscreen);
+                        changes.SetFullscreen(notification.fullscreen);
+                        break;
+
+                    case Type::FocusedChanged:
+                        focused.Notify(notification.flag);
+                        changes.SetFocused(notification.flag);
+                        break;
+
+                    case Type::VisibleChanged:
+                        visible.Notify(notification.flag);
+                        changes.SetVisible(notification.flag);
+                        break;
+
+                    case Type::AlwaysOnTopChanged:
+                        always_on_top.Notify(notification.flag);
+                        changes.SetAlwaysOnTop(notification.flag);
+                        break;
+
+                    case Type::SwapIntervalChanged:
+                        swap_interval.Notify(notification.swap_interval);
+                        changes.SetSwapInterval(notification.swap_interval);
+                        break;
+
+                    case Type::TitleChanged:
+                        title.Notify(notification.title);
+                        changes.SetTitle(notification.title);
+                        break;
+
+                    case Type::Close:
+                        close = true;
+                        break;
+                }
+            }
+
+            if(changes.flags != 0) {
+                signal_properties_changed.Emit(changes);
+            }
+
+            if(close) {
+                Close();
+            }
+        }
+
+        void Window::onSizeChanged(Size)
+        {
+            Invalidate();
+
+            if(!m_live_resize_config.enabled) {
+                return;
+            }
+
+            TimePoint const now = std::chrono::steady_clock::now();
+            TimePoint const prev_resize_time = m_resize_time;
+            m_resize_time = now;
+
+            if(m_live_resize ||
+               now-prev_resize_time >= m_live_resize_config.settle_time)
+            {
+                return;
+            }
+
+            // The size is changing quickly
+            m_live_resize = true;
+
+            if(!m_live_resize_timer) {
+                m_live_resize_timer =
+                        MakeObject<CallbackTimer>(
+                            this->GetEventLoop(),
+                            m_live_resize_config.settle_time,
+                            [this](){
+                                this->onLiveResizeTimeout();
+                            });
+            }
+
+            m_live_resize_timer->Start();
+            signal_live_resize.Emit(true);
+        }
+
+        void Window::onLiveResizeTimeout()
+        {
+            TimePoint const now = std::chrono::steady_clock::now();
+            if(now-m_resize_time < m_live_resize_config.settle_time) {
+                return;
+            }
+
+            m_live_resize_timer->Stop();
+            m_live_resize = false;
+            signal_live_resize.Emit(false);
+
+            // The last frame may have been rendered at a reduced
+            // resolution; make sure a full resolution one follows
+            Invalidate();
+        }
+
+        void Window::onFocusedChanged(bool)
+        {
+            // The frame rate may change
+            Invalidate();
+        }
+
+        void Window::onVisibleChanged(bool)
+        {
+            Invalidate();
+        }
+
+        void Window::onFrameRequested()
+        {
+            KS_GUI_TRACE_SCOPE("Window::onFrameRequested",this->GetId());
+
+            if(m_closed) {
+                m_frame_requested = false;
+                return;
+            }
+
+            if(!m_ready) {
+                m_ready = true;
+                onWindowReady();
+            }
+
+            // Cleared after the Window is ready so that its
+            // Invalidate is merged into this frame; requests
+            // made from here on post the task again
+            m_frame_requested = false;
+
+            if(m_governor_enabled) {
+                onGovernorSchedule();
+                return;
+            }
+
+            m_governor_scheduled = false;
+
+            if(m_block_rendering) {
+                return;
+            }
+
+            signal_frame.Emit();
+        }
+
+        void Window::postFrameTask()
+        {
+            if(!m_frame_requested.exchange(true)) {
+                this->GetEventLoop()->PostTask(m_frame_task);
+            }
+        }
+
+        void Window::onGovernorSchedule()
+        {
+            if(!m_governor_enabled || m_block_rendering) {
+                m_governor_scheduled = false;
+                setGovernorState(FrameGovernorState::Idle);
+                return;
+            }
+
+            FrameGovernorConfig config;
+            {
+                std::lock_guard<std::mutex> lock(m_governor_mutex);
+                config = m_governor_config;
+            }
+
+            if(config.pause_when_hidden && !visible.Get()) {
+                m_governor_scheduled = false;
+                setGovernorState(FrameGovernorState::Idle);
+                return;
+            }
+
+            bool const throttle =
+                    !focused.Get() &&
+                    config.unfocused_frame_interval.count() > 0;
+
+            if(!throttle) {
+                setGovernorState(FrameGovernorState::Active);
+                renderGovernorFrame();
+                return;
+            }
+
+            setGovernorState(FrameGovernorState::Throttled);
+
+            TimePoint const now = std::chrono::steady_clock::now();
+            if(now-m_governor_frame_time >= config.unfocused_frame_interval) {
+                renderGovernorFrame();
+                return;
+            }
+
+            // Wait before rendering the next frame. Requests
+            // made until then are merged into this frame since
+            // m_governor_scheduled stays set.
+            if(!m_governor_timer ||
+               m_governor_timer_interval != config.unfocused_frame_interval)
+            {
+                if(m_governor_timer) {
+                    m_governor_timer->Stop();
+                }
+
+                m_governor_timer_interval = config.unfocused_frame_interval;
+                m_governor_timer =
+                        MakeObject<CallbackTimer>(
+                            this->GetEventLoop(),
+                            m_governor_timer_interval,
+                            [this](){
+                                this->onGovernorTimeout();
+                            });
+            }
+
+            m_governor_timer->Start();
+        }
+
+        void Window::onGovernorTimeout()
+        {
+            m_governor_timer->Stop();
+
+            if(!m_governor_enabled || m_block_rendering) {
+                m_governor_scheduled = false;
+                setGovernorState(FrameGovernorState::Idle);
+                return;
+            }
+
+            renderGovernorFrame();
+        }
+
+        void Window::requestGovernorFrame()
+        {
+            if(!m_governor_scheduled.exchange(true)) {
+                postFrameTask();
+            }
+        }
+
+        void Window::renderGovernorFrame()
+        {
+            KS_GUI_TRACE_SCOPE("Window::renderGovernorFrame",this->GetId());
+
+            // Clear these first so changes made while
+            // rendering schedule another frame
+            m_governor_scheduled = false;
+            m_governor_dirty = false;
+            m_governor_frame_time = std::chrono::steady_clock::now();
+
+            {
+                std::lock_guard<std::mutex> lock(m_governor_mutex);
+                m_governor_stats.frames++;
+            }
+
+            signal_frame.Emit();
+
+            if(m_governor_animations > 0 || m_governor_dirty) {
+                requestGovernorFrame();
+            }
+            else {
+                setGovernorState(FrameGovernorState::Idle);
+            }
+        }
+
+        void Window::setGovernorState(FrameGovernorState state)
+        {
+            std::lock_guard<std::mutex> lock(m_governor_mutex);
+
+            if(m_governor_stats.state == state) {
+                return;
+            }
+
+            TimePoint const now = std::chrono::steady_clock::now();
+
+            if(m_governor_stats.state == FrameGovernorState::Idle) {
+                m_governor_stats.idle_time +=
+                        std::chrono::duration_cast<Microseconds>(
+                            now-m_governor_idle_start);
+            }
+            else if(state == FrameGovernorState::Idle) {
+                m_governor_idle_start = now;
+            }
+
+            m_governor_stats.state = state;
         }
 
         void Window::setContextCurrent()
         {
-            signal_make_context_current.Emit();
+            KS_GUI_TRACE_SCOPE("Window::MakeContextCurrent",this->GetId());
+
+            if(m_platform_window == nullptr) {
+                return;
+            }
+
+            m_metrics->context_switches.fetch_add(1,std::memory_order_relaxed);
+            PlatformWindowDispatch::MakeContextCurrent(m_platform_window);
+        }
+
+        void Window::queueAppInput()
+        {
+            m_metrics->pending_input.fetch_add(1,std::memory_order_relaxed);
+        }
+
+        void Window::swapBuffers()
+        {
+            if(m_platform_window == nullptr) {
+                return;
+            }
+
+            PlatformWindowDispatch::SwapBuffers(m_platform_window);
+            m_metrics->frames_rendered.fetch_add(1,std::memory_order_relaxed);
+
+            if(m_has_gl_context) {
+                KS_GUI_TRACE_SCOPE("Window::WaitForGpu",this->GetId());
+                m_frame_pacer.OnSwapBuffers();
+            }
+
+            m_frame_arena.EndFrame();
+        }
+
+        void Window::invalidateRenderContexts()
+        {
+            m_render_generation.fetch_add(1,std::memory_order_release);
+        }
+
+        void Window::releaseContext()
+        {
+            KS_GUI_TRACE_SCOPE("Window::ReleaseContext",this->GetId());
+
+            if(m_platform_window == nullptr) {
+                return;
+            }
+
+            // Fences belong to the context so they have
+            // to be deleted while it's still current
+            if(m_has_gl_context && m_frame_pacer.GetHasPendingFrames()) {
+                setContextCurrent();
+                m_frame_pacer.Release();
+            }
+
+            PlatformWindowDispatch::ReleaseContext(m_platform_window);
         }
 
         // ============================================================= //
@@ -17,11 +17,17 @@
 #ifndef KS_GUI_WINDOW_HPP
 #define KS_GUI_WINDOW_HPP
 
+#include <mutex>
 #include <ks/KsSignal.hpp>
 #include <ks/shared/KsDeferredProperty.hpp>
 #include <ks/shared/KsCallbackTimer.hpp>
 #include <ks/gl/KsGLConfig.hpp>
 #include <ks/gui/KsGuiConfig.hpp>
+#include <ks/gui/KsGuiInput.hpp>
+#include <ks/gui/KsGuiFramePacer.hpp>
+#include <ks/gui/KsGuiFrameArena.hpp>
+#include <ks/gui/KsGuiMetrics.hpp>
+#include <ks/gui/KsGuiProgramCache.hpp>
 
 namespace ks
 {
@@ -45,9 +51,66 @@ namespace ks
 
         // ============================================================= //
 
+        class IPlatformWindow;
+        class WindowCommandChannel;
+        struct WindowNotification;
+        struct WindowNotifyInbox;
+        class Window;
+
+        // ============================================================= //
+
+        // * A direct handle to a Window's graphics context for
+        //   the render thread, see Window::AcquireRenderContext
+        // * Calls go straight to the platform window without
+        //   any signals. The handle becomes invalid when the
+        //   Window stops rendering (the application is paused
+        //   or the Window is closed) and every call then
+        //   returns false; acquire a new one once it resumes.
+        // * Must only be used from the Window's thread and
+        //   while the Window is alive
+        class RenderContext final
+        {
+        public:
+            // * Creates an invalid context
+            RenderContext();
+
+            bool IsValid() const;
+
+            bool MakeCurrent();
+            bool SwapBuffers();
+
+            // * Sets the swap interval for following swaps; the
+            //   context must be current
+            // * Returns false if the context is invalid or the
+            //   platform window can't set the interval per swap
+            //   (see IPlatformWindow::GetHasContextSwapInterval)
+            bool SetSwapInterval(uint swap_interval);
+
+            // * Changes whenever the Window's context may have
+            //   been recreated (after a pause or a graphics
+            //   reset), so state set on the context such as the
+            //   swap interval has to be set again
+            u32 GetContextGeneration() const;
+
+            // * The size of the window surface in pixels; zero
+            //   if the context is invalid
+            std::pair<uint,uint> GetSurfaceSize() const;
+
+        private:
+            friend class Window;
+
+            RenderContext(Window* window, u32 generation);
+
+            Window* m_window;
+            u32 m_generation;
+        };
+
+        // ============================================================= //
+
         class Window final : public ks::Object
         {
             friend class Application;
+            friend class RenderContext;
 
         public:
             using base_type = ks::Object;
@@ -132,6 +195,96 @@ namespace ks
                 bool forward_compat;
             };
 
+            struct NotifyStats final
+            {
+                // * Size and position changes reported
+                //   by the platform
+                u64 received;
+
+                // * Notify calls made on the properties
+                u64 delivered;
+
+                // * Changes that were replaced by a newer
+                //   value before they were delivered
+                u64 collapsed;
+            };
+
+            struct LiveResizeConfig final
+            {
+                LiveResizeConfig() :
+                    enabled(false),
+                    settle_time(150),
+                    bucket_size(128),
+                    scale(0.5f)
+                {}
+
+                bool enabled;
+
+                // * A live resize starts when the size changes twice
+                //   within settle_time and ends once it hasn't
+                //   changed for settle_time
+                Milliseconds settle_time;
+
+                // * During a live resize the buffer size is rounded
+                //   up to a multiple of bucket_size so buffers are
+                //   only reallocated when a bucket boundary is crossed
+                uint bucket_size;
+
+                // * During a live resize content is rendered at
+                //   this fraction of the window size
+                float scale;
+            };
+
+            struct RenderTarget final
+            {
+                // * The size to allocate the back buffer at
+                Size buffer_size;
+
+                // * The region of the back buffer to render into.
+                //   It should be upscaled to fill the window when
+                //   it's smaller than the window.
+                Size viewport_size;
+
+                bool live_resize;
+            };
+
+            struct FrameGovernorConfig final
+            {
+                FrameGovernorConfig() :
+                    enabled(false),
+                    unfocused_frame_interval(0),
+                    pause_when_hidden(true)
+                {}
+
+                // * When enabled the Window schedules frames
+                //   itself (see signal_frame) and stops once
+                //   nothing has changed
+                bool enabled;
+
+                // * Minimum time between frames while the window
+                //   isn't focused. Zero doesn't limit the rate.
+                Milliseconds unfocused_frame_interval;
+
+                // * Don't render while the window isn't visible
+                bool pause_when_hidden;
+            };
+
+            enum class FrameGovernorState
+            {
+                Active,     // rendering at the display rate
+                Throttled,  // rendering at a reduced rate
+                Idle        // not rendering
+            };
+
+            struct FrameGovernorStats final
+            {
+                FrameGovernorState state;
+                u64 frames;
+
+                // * Total time spent in the Idle state
+                Microseconds idle_time;
+            };
+
             struct Properties final
             {
                 Properties() :
@@ -163,6 +316,48 @@ namespace ks
                 std::string title;
             };
 
+            // * A set of property changes applied together, see
+            //   Window::ApplyProperties. Only the values whose
+            //   flag is set are used.
+            struct PropertyChanges final
+            {
+                static u16 const SIZE           = 1 << 0;
+                static u16 const POSITION       = 1 << 1;
+                static u16 const FULLSCREEN     = 1 << 2;
+                static u16 const FOCUSED        = 1 << 3;
+                static u16 const VISIBLE        = 1 << 4;
+                static u16 const ALWAYS_ON_TOP  = 1 << 5;
+                static u16 const SWAP_INTERVAL  = 1 << 6;
+                static u16 const TITLE          = 1 << 7;
+
+                PropertyChanges();
+
+                PropertyChanges& SetSize(Size new_size);
+                PropertyChanges& SetPosition(Position new_position);
+                PropertyChanges& SetFullscreen(FullscreenMode new_fullscreen);
+                PropertyChanges& SetFocused(bool new_focused);
+                PropertyChanges& SetVisible(bool new_visible);
+                PropertyChanges& SetAlwaysOnTop(bool new_always_on_top);
+                PropertyChanges& SetSwapInterval(uint new_swap_interval);
+                PropertyChanges& SetTitle(std::string new_title);
+
+                bool GetHas(u16 flag) const;
+
+                // * Adds the values in @older that aren't set
+                //   in this one
+                void Merge(PropertyChanges const &older);
+
+                u16 flags;
+                Size size;
+                Position position;
+                FullscreenMode fullscreen;
+                bool focused;
+                bool visible;
+                bool always_on_top;
+                uint swap_interval;
+                std::string title;
+            };
+
             /// * Creates a Window object *after* the corresponding
             ///   system window has been created by ks::gui::Application
             /// * Only ks::gui::Application should ever create objects
@@ -207,10 +402,139 @@ namespace ks
             bool SetContextCurrent();
             void SwapBuffers();
 
+            // * Returns a handle that render loops can use to make
+            //   the context current and swap without going through
+            //   this Window's checks each frame
+            // * The handle is invalid if rendering is currently
+            //   blocked (ie. the application is paused)
+            RenderContext AcquireRenderContext();
+
+            // * Applies all of @changes to the platform window in
+            //   a single call, avoiding the intermediate resizes
+            //   and redraws of setting each property separately
+            // * The properties are notified as the platform
+            //   confirms them, followed by one
+            //   signal_properties_changed
+            void ApplyProperties(PropertyChanges const &changes);
+
             // * Stops rendering and signals the Application
             //   to close the window.
             void Close();
 
+            // * When enabled, size and position changes from the
+            //   platform are coalesced so that only the newest
+            //   value is notified, at most once per EventLoop
+            //   iteration. Useful to avoid relayouts for every
+            //   intermediate value while a window is dragged
+            //   or resized.
+            // * Disabled by default
+            // * Thread safe
+            void SetNotifyCoalescing(bool enabled);
+
+            // * Notifies any pending coalesced size and position
+            //   changes immediately (ie. at the start of a frame)
+            void FlushNotifications();
+
+            // * Thread safe
+            NotifyStats GetNotifyStats() const;
+
+            // * Interactive resizing makes every intermediate size
+            //   a full size reallocation and render; a live resize
+            //   lets the render path use a bucketed, reduced
+            //   resolution target instead (see GetRenderTarget)
+            void SetLiveResizeConfig(LiveResizeConfig const &config);
+
+            // * Returns the target the next frame should be
+            //   rendered to
+            // * Outside of a live resize this is always the
+            //   full window size
+            RenderTarget GetRenderTarget() const;
+
+            // * Frames are only scheduled while the contents may
+            //   change: after Invalidate, while an animation is
+            //   active or when input or a property change is
+            //   received. Otherwise the governor goes idle.
+            // * Thread safe
+            void SetFrameGovernorConfig(FrameGovernorConfig const &config);
+
+            // * Marks the contents as changed so that a frame
+            //   is scheduled
+            // * Thread safe
+            void Invalidate();
+
+            // * Schedules signal_frame on this Window's EventLoop
+            // * Requests made before the frame runs are merged
+            //   into it. Each Window reuses a single task for
+            //   this so requesting frames doesn't allocate.
+            // * With the governor enabled this is the same as
+            //   Invalidate; the governor decides when to render
+            // * Thread safe
+            void RequestFrame();
+
+            // * Frames are scheduled continuously between calls
+            //   to BeginAnimation and the matching EndAnimation
+            // * Thread safe
+            void BeginAnimation();
+            void EndAnimation();
+
+            // * Thread safe
+            FrameGovernorStats GetFrameGovernorStats() const;
+
+            // * Limits how many frames SwapBuffers lets the CPU
+            //   queue ahead of the GPU (see FramePacer)
+            // * 1 favours latency, 3 (the default) throughput
+            // * Thread safe
+            void SetMaxFramesInFlight(uint count);
+
+            // * Returns how long frames waited for the GPU
+            //   after SwapBuffers
+            // * Thread safe
+            FramePacer::Stats GetFramePacingStats() const;
+
+            // * Returns the arena for this Window's per frame
+            //   data (see FrameArena). It's reset after each
+            //   SwapBuffers, so anything allocated from it stays
+            //   valid until the end of the next frame.
+            // * Must only be used from this Window's EventLoop,
+            //   ie. in InvokeWithContext callbacks or slots
+            //   connected to signal_frame
+            FrameArena& GetFrameArena();
+
+            // * Thread safe
+            FrameArena::Stats GetFrameArenaStats() const;
+
+            // * Sets the cache render code should build its
+            //   programs with (see ProgramCache); the cache can
+            //   be shared between windows. Pass nullptr to
+            //   disable it.
+            // * Thread safe
+            void SetProgramCache(shared_ptr<ProgramCache> cache);
+            shared_ptr<ProgramCache> GetProgramCache() const;
+
+            // * Emitted from this Window's EventLoop after the
+            //   graphics context was reset. All GL objects must
+            //   be recreated; programs built with the program
+            //   cache are loaded from their cached binaries.
+            Signal<> signal_graphics_reset;
+
+            // * Emitted from this Window's EventLoop for each
+            //   frame scheduled by the governor or RequestFrame,
+            //   and once when the Window is ready to render.
+            //   Slots should render and call SwapBuffers.
+            Signal<> signal_frame;
+
+            // * Emitted once for each batch of property changes
+            //   reported by the platform, with the new values
+            //   of every property that changed
+            Signal<PropertyChanges> signal_properties_changed;
+
+            // * Emitted with true when a live resize starts and
+            //   with false once the size has settled
+            // * With the governor enabled the Window invalidates
+            //   itself after the false emit, so a full resolution
+            //   frame follows. Otherwise slots should request one.
+            Signal<bool> signal_live_resize;
+
 
             // Properties
             DeferredProperty<Size> size;
@@ -222,26 +546,174 @@ namespace ks
             DeferredProperty<uint> swap_interval;
             DeferredProperty<std::string> title;
 
+            // Input
+            // * Only emitted for events directed at this window
+            // * Emitted from this Window's EventLoop
+            // * Mouse and touch coordinates are in logical
+            //   window units
+            Signal<KeyEvent> signal_keyboard_input;
+            Signal<TextInputEvent> signal_text_input;
+            Signal<MouseEvent> signal_mouse_input;
+            Signal<TouchEvent> signal_touch_input;
+            Signal<ScrollEvent> signal_scroll_input;
+
         private:
-            // Window ---> Application
-            Signal<> signal_make_context_current;
-            Signal<> signal_release_context;
-            Signal<> signal_swap_buffers;
-            Signal<Id> signal_app_close_window;
+            // Window ---> PlatformWindow
+            // * Property requests and close are queued to
+            //   m_command_channel
+            void onSizeSet(Size new_size);
+            void onPositionSet(Position new_position);
+            void onFullscreenSet(FullscreenMode new_fullscreen);
 
             // Application ---> Window
+            // * Routed input is emitted on these from the
+            //   Application's thread and queued to this
+            //   Window's EventLoop
+            Signal<KeyEvent> signal_app_keyboard_input;
+            Signal<TextInputEvent> signal_app_text_input;
+            Signal<MouseEvent> signal_app_mouse_input;
+            Signal<TouchEvent> signal_app_touch_input;
+            Signal<ScrollEvent> signal_app_scroll_input;
+
             void onAppInit();
             void onAppPause();
             void onAppResume();
             void onAppQuit();
             void onAppGraphicsReset();
             void onWindowReady();
+            void onAppKeyboardInput(KeyEvent event);
+            void onAppTextInput(TextInputEvent event);
+            void onAppMouseInput(MouseEvent event);
+            void onAppTouchInput(TouchEvent event);
+            void onAppScrollInput(ScrollEvent event);
+
+            // PlatformWindow ---> Window
+            // * Invoked from the Application's thread
+            void onPlatformSizeChanged(Size new_size);
+            void onPlatformPositionChanged(Position new_position);
+
+            // * Each batch of notifications is pushed to
+            //   m_notify_inbox and handled on this Window's
+            //   EventLoop. Size and position have already been
+            //   handled by the methods above.
+            void onPlatformNotifications(
+                    std::vector<WindowNotification> const &list_notifications);
+            void onNotifyTask();
+
+            // * Queued to this Window's EventLoop
+            Signal<Size> signal_notify_size;
+            Signal<Position> signal_notify_position;
+            Signal<> signal_flush_notifications;
+
+            void onSizeChanged(Size new_size);
+            void onLiveResizeTimeout();
+
+            void onFocusedChanged(bool);
+            void onVisibleChanged(bool);
+            void onFrameRequested();
+            void postFrameTask();
+            void onGovernorSchedule();
+            void onGovernorTimeout();
+            void requestGovernorFrame();
+            void renderGovernorFrame();
+            void setGovernorState(FrameGovernorState state);
 
             void setContextCurrent();
+            void swapBuffers();
+            void releaseContext();
+
+            // * Invalidates all RenderContexts; called whenever
+            //   rendering is blocked
+            void invalidateRenderContexts();
+
+            // * Counts input queued to this Window's EventLoop
+            //   by the Application as a pending task
+            void queueAppInput();
 
             Attributes m_attributes;
             std::atomic<bool> m_closed;
             std::atomic<bool> m_block_rendering;
+
+            template<typename T>
+            struct PendingNotify
+            {
+                bool valid;
+                T value;
+            };
+
+            std::atomic<bool> m_notify_coalescing;
+            std::mutex m_notify_mutex;
+            bool m_notify_flush_queued;
+            PendingNotify<Size> m_pending_size;
+            PendingNotify<Position> m_pending_position;
+
+            std::atomic<u64> m_notify_received;
+            std::atomic<u64> m_notify_delivered;
+            std::atomic<u64> m_notify_collapsed;
+
+            LiveResizeConfig m_live_resize_config;
+            bool m_live_resize;
+            TimePoint m_resize_time;
+            shared_ptr<CallbackTimer> m_live_resize_timer;
+
+            // * Posted for every frame request and reused; it's
+            //   only reposted after it starts running
+            // * The first run after the Window is created starts
+            //   rendering (see Application::CreateWindow)
+            shared_ptr<Task> m_frame_task;
+            std::atomic<bool> m_frame_requested;
+            bool m_ready;
+
+            std::atomic<bool> m_governor_enabled;
+            std::atomic<bool> m_governor_dirty;
+            std::atomic<bool> m_governor_scheduled;
+            std::atomic<uint> m_governor_animations;
+            shared_ptr<CallbackTimer> m_governor_timer;
+            Milliseconds m_governor_timer_interval;
+            TimePoint m_governor_frame_time;
+
+            // * Guards the config and stats which may be
+            //   accessed from other threads
+            mutable std::mutex m_governor_mutex;
+            FrameGovernorConfig m_governor_config;
+            FrameGovernorStats m_governor_stats;
+            TimePoint m_governor_idle_start;
+
+            FramePacer m_frame_pacer;
+            FrameArena m_frame_arena;
+
+            mutable std::mutex m_program_cache_mutex;
+            shared_ptr<ProgramCache> m_program_cache;
+
+            shared_ptr<Metrics::WindowCounters> m_metrics;
+
+            // * Drained in batches by the Application
+            shared_ptr<WindowCommandChannel> m_command_channel;
+
+            // * Filled by the Application and drained by
+            //   m_notify_task, which is posted once each
+            //   time the inbox becomes non empty
+            shared_ptr<WindowNotifyInbox> m_notify_inbox;
+            shared_ptr<Task> m_notify_task;
+
+            // Window ---> PlatformWindow (render path)
+            // * Called through PlatformWindowDispatch so that
+            //   it's bound at compile time when possible
+            // * Set by the Application before the Window is
+            //   ready and cleared when it's closed; the
+            //   platform window is only destroyed after that
+            IPlatformWindow* m_platform_window;
+
+            // * False for platform windows without a GL context;
+            //   frame pacing is skipped for them
+            bool m_has_gl_context;
+
+            // * Incremented each time rendering is blocked
+            std::atomic<u32> m_render_generation;
+
+            // * Incremented each time the context is released
+            //   or reset (see RenderContext::GetContextGeneration)
+            std::atomic<u32> m_context_generation;
         };
 
     } // gui
@@ -0,0 +1,299 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_WINDOW_CHANNEL_HPP
+#define KS_GUI_WINDOW_CHANNEL_HPP
+
+#include <mutex>
+#include <vector>
+#include <ks/gui/KsGuiWindow.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        // ============================================================= //
+
+        // * A bounded, thread safe queue of messages that's
+        //   drained in batches by a single consumer
+        // * When the queue is full, messages that have been
+        //   superseded by a newer message of the same type are
+        //   dropped. Since only the latest value of a property
+        //   matters this keeps the queue within Capacity
+        //   without ever blocking the producer.
+        // * Message must have a 'type' member of an enum with
+        //   Message::TypeCount values and a static
+        //   Coalesce(newer,older) that merges anything
+        //   from a dropped message the newer one should keep
+        template<typename Message, uint Capacity>
+        class MessageChannel
+        {
+            static_assert(Capacity > Message::TypeCount,
+                          "MessageChannel: Capacity must be greater "
+                          "than the number of message types");
+
+        public:
+            MessageChannel() :
+                m_drain_pending(false),
+                m_collapsed(0)
+            {
+                m_list_messages.reserve(Capacity);
+            }
+
+            // * @callback is invoked (outside of the lock) by the
+            //   Push that makes the channel non empty; the owner
+            //   should schedule a Drain
+            void SetPendingCallback(std::function<void()> callback)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_pending_callback = std::move(callback);
+            }
+
+            void Push(Message message)
+            {
+                std::function<void()> callback;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+
+                    if(m_list_messages.size() == Capacity) {
+                        compact();
+                    }
+
+                    m_list_messages.push_back(std::move(message));
+
+                    if(!m_drain_pending) {
+                        m_drain_pending = true;
+                        callback = m_pending_callback;
+                    }
+                }
+
+                if(callback) {
+                    callback();
+                }
+            }
+
+            // * Moves all queued messages into @list_messages
+            //   (which is cleared first) in the order they
+            //   were pushed
+            // * Swaps buffers so that neither side allocates
+            //   once both have reached their working size
+            void Drain(std::vector<Message> &list_messages)
+            {
+                list_messages.clear();
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_list_messages.swap(list_messages);
+                m_list_messages.reserve(Capacity);
+                m_drain_pending = false;
+            }
+
+            // * Messages dropped because a newer one
+            //   of the same type replaced them
+            u64 GetCollapsedCount() const
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return m_collapsed;
+            }
+
+        private:
+            void compact()
+            {
+                // Keep the newest message of each type
+                Message* list_newest[Message::TypeCount] = {};
+
+                auto keep = m_list_messages.end();
+                for(auto it = m_list_messages.end();
+                    it != m_list_messages.begin();)
+                {
+                    --it;
+                    uint const type = static_cast<uint>(it->type);
+
+                    if(list_newest[type] == nullptr) {
+                        --keep;
+                        if(keep != it) {
+                            *keep = std::move(*it);
+                        }
+                        list_newest[type] = &(*keep);
+                    }
+                    else {
+                        Message::Coalesce(*(list_newest[type]),*it);
+                        m_collapsed++;
+                    }
+                }
+
+                m_list_messages.erase(m_list_messages.begin(),keep);
+            }
+
+            mutable std::mutex m_mutex;
+            std::vector<Message> m_list_messages;
+            std::function<void()> m_pending_callback;
+            bool m_drain_pending;
+            u64 m_collapsed;
+        };
+
+        // ============================================================= //
+
+        // * PlatformWindow ---> Window
+        struct WindowNotification final
+        {
+            enum class Type : u8
+            {
+                SizeChanged,
+                PositionChanged,
+                FullscreenChanged,
+                FocusedChanged,
+                VisibleChanged,
+                AlwaysOnTopChanged,
+                SwapIntervalChanged,
+                TitleChanged,
+                Close
+            };
+
+            static uint const TypeCount = 9;
+
+            static void Coalesce(WindowNotification &,
+                                 WindowNotification const &)
+            {
+                // Only the latest value matters
+            }
+
+            Type type;
+            Window::Size size;
+            Window::Position position;
+            Window::FullscreenMode fullscreen;
+
+            // * The value for focused, visible and always
+            //   on top changes
+            bool flag;
+
+            uint swap_interval;
+            std::string title;
+        };
+
+        // ============================================================= //
+
+        // * Window ---> PlatformWindow
+        // * Every property change, including size, position and
+        //   fullscreen, is merged into a single pending transaction
+        //   with newer values replacing older ones. Changes are
+        //   therefore always applied in the order they were made,
+        //   and pushing never blocks or grows the channel.
+        // * The transaction is applied before a pending close
+        class WindowCommandChannel final
+        {
+        public:
+            WindowCommandChannel() :
+                m_drain_pending(false),
+                m_close(false)
+            {}
+
+            // * @callback is invoked (outside of the lock) by the
+            //   push that makes the channel non empty; the owner
+            //   should schedule a Drain
+            void SetPendingCallback(std::function<void()> callback)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_pending_callback = std::move(callback);
+            }
+
+            void PushProperties(Window::PropertyChanges const &changes)
+            {
+                std::function<void()> callback;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+
+                    // Both transactions keep their capacity
+                    m_merged = changes;
+                    m_merged.Merge(m_properties);
+                    std::swap(m_merged,m_properties);
+
+                    callback = setDrainPending();
+                }
+
+                if(callback) {
+                    callback();
+                }
+            }
+
+            void PushClose()
+            {
+                std::function<void()> callback;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_close = true;
+                    callback = setDrainPending();
+                }
+
+                if(callback) {
+                    callback();
+                }
+            }
+
+            // * Moves the pending transaction into @properties,
+            //   whose flags are 0 if there isn't one
+            // * Returns true if the window should be closed
+            //   after the transaction is applied
+            bool Drain(Window::PropertyChanges &properties)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+
+                std::swap(properties,m_properties);
+                m_properties.flags = 0;
+                m_drain_pending = false;
+
+                bool const close = m_close;
+                m_close = false;
+                return close;
+            }
+
+        private:
+            std::function<void()> setDrainPending()
+            {
+                if(m_drain_pending) {
+                    return nullptr;
+                }
+
+                m_drain_pending = true;
+                return m_pending_callback;
+            }
+
+            std::mutex m_mutex;
+            Window::PropertyChanges m_properties;
+            Window::PropertyChanges m_merged;
+            std::function<void()> m_pending_callback;
+            bool m_drain_pending;
+            bool m_close;
+        };
+
+        class WindowNotifyChannel final :
+                public MessageChannel<WindowNotification,32>
+        {};
+
+        // * Platform notifications on their way to a Window
+        // * The Application pushes each batch to the channel
+        //   and the Window drains it into list_batch from its
+        //   EventLoop; both keep their capacity
+        struct WindowNotifyInbox final
+        {
+            WindowNotifyChannel channel;
+            std::vector<WindowNotification> list_batch;
+        };
+
+        // ============================================================= //
+    }
+}
+
+#endif // KS_GUI_WINDOW_CHANNEL_HPP
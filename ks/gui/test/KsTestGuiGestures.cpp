@@ -0,0 +1,106 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <ks/gui/KsGuiWindow.hpp>
+#include <ks/gui/KsGuiApplication.hpp>
+#include <ks/gui/KsGuiGesture.hpp>
+#include <ks/platform/KsPlatformMain.hpp>
+
+using namespace ks;
+
+namespace {
+
+    shared_ptr<gui::GestureRecognizer> gesture_recognizer;
+
+    std::string GetGestureName(gui::GestureEvent::Type type)
+    {
+        if(type == gui::GestureEvent::Type::Pan) {
+            return "Pan";
+        }
+        else if(type == gui::GestureEvent::Type::Pinch) {
+            return "Pinch";
+        }
+        else if(type == gui::GestureEvent::Type::Fling) {
+            return "Fling";
+        }
+        return "LongPress";
+    }
+
+    void PrintGesture(gui::GestureEvent event)
+    {
+        LOG.Trace() << "GestureEvent: "
+                    << GetGestureName(event.type) << ", "
+                    << "state: " << static_cast<uint>(event.state) << ", "
+                    << "x: " << event.x << ", y: " << event.y << ", "
+                    << "dx: " << event.dx << ", dy: " << event.dy << ", "
+                    << "scale: " << event.scale << ", "
+                    << "vx: " << event.vx << ", vy: " << event.vy;
+    }
+
+    void UpdateGestures(bool)
+    {
+        // Lets long presses be detected without finger motion
+        gesture_recognizer->Update(std::chrono::steady_clock::now());
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    (void)argc;
+    (void)argv;
+
+
+    // Create application
+    shared_ptr<gui::Application> app =
+            MakeObject<gui::Application>();
+
+    gui::Window::Attributes win_attribs;
+    gui::Window::Properties win_props;
+
+
+    // Create window using the application's EventLoop
+    shared_ptr<gui::Window> win =
+            app->CreateWindow(
+                app->GetEventLoop(),
+                win_attribs,
+                win_props);
+
+
+    // Create the gesture recognizer
+    gesture_recognizer =
+            MakeObject<gui::GestureRecognizer>(
+                app->GetEventLoop());
+
+    app->signal_touch_input->Connect(
+                gesture_recognizer,
+                &gui::GestureRecognizer::ProcessTouchEvent,
+                ConnectionType::Direct);
+
+    app->signal_processed_events->Connect(
+                &UpdateGestures);
+
+    gesture_recognizer->signal_gesture.Connect(
+                &PrintGesture);
+
+
+    // Run!
+    app->Run();
+
+    gesture_recognizer = nullptr;
+
+
+    return 0;
+}
@@ -0,0 +1,487 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <ks/gui/KsGuiWindow.hpp>
+#include <ks/gui/KsGuiApplication.hpp>
+#include <ks/gui/KsGuiImage.hpp>
+#include <ks/gui/KsGuiImageDiff.hpp>
+#include <ks/gui/KsGuiShmPlatform.hpp>
+#include <ks/platform/KsPlatformMain.hpp>
+
+// Renders a set of scenes through a Window, reads each
+// presented frame back and compares it to the golden
+// image in the given directory
+
+// Runs headless: build with KS_GUI_PLATFORM_SHM so the
+// window is a ShmPlatformWindow. The ShmPlatform has no
+// GL, so scenes are rasterized on the CPU into the
+// window's surface; everything after that goes through
+// the library: frames are scheduled with RequestFrame
+// and signal_frame, resized with ApplyProperties,
+// published with SwapBuffers and captured from the
+// shared framebuffer with ShmFrameReader like any other
+// consumer would.
+#ifndef KS_GUI_PLATFORM_SHM
+    #error "KsTestGuiGolden must be built with KS_GUI_PLATFORM_SHM"
+#endif
+
+// Usage: KsTestGuiGolden [golden_dir] [--update]
+// The goldens are in ks/gui/test/golden
+// --update writes the captured frames as the new goldens
+// Failing frames are written as <name>.actual.pam along
+// with a <name>.diff.ppm showing the differing pixels
+
+using namespace ks;
+
+namespace
+{
+    struct Rect
+    {
+        sint x;
+        sint y;
+        sint width;
+        sint height;
+        float r;
+        float g;
+        float b;
+    };
+
+    struct GoldenScene
+    {
+        std::string name;
+        gui::Window::Size size;
+        std::vector<Rect> list_rects;
+    };
+
+    // Channel tolerance for color rounding differences
+    u8 const g_tolerance = 2;
+
+    std::vector<GoldenScene> CreateScenes()
+    {
+        std::vector<GoldenScene> list_scenes;
+
+        list_scenes.push_back(GoldenScene{"clear_black",{320,240},{}});
+
+        std::vector<Rect> const list_layers{
+            Rect{20,20,120,80,1,0,0},
+            Rect{40,40,120,80,0,1,0},
+            Rect{60,60,120,80,0,0,1}};
+
+        list_scenes.push_back(GoldenScene{"layers",{320,240},list_layers});
+
+        // Rects that touch every edge
+        list_scenes.push_back(
+                    GoldenScene{"edges",{320,240},{
+                                    Rect{0,0,320,1,1,1,1},
+                                    Rect{0,239,320,1,1,1,1},
+                                    Rect{0,0,1,240,1,1,0},
+                                    Rect{319,0,1,240,0,1,1}}});
+
+        // Many small tiles
+        GoldenScene grid{"grid",{320,240},{}};
+        for(sint y=0; y < 240; y += 16) {
+            for(sint x=0; x < 320; x += 16) {
+                if(((x+y)/16) % 2 == 0) {
+                    grid.list_rects.push_back(
+                                Rect{x,y,16,16,x/320.0f,y/240.0f,0.5f});
+                }
+            }
+        }
+        list_scenes.push_back(grid);
+
+        // The window is resized first; the layers are
+        // clipped to the smaller frame
+        list_scenes.push_back(GoldenScene{"resized",{160,120},list_layers});
+
+        return list_scenes;
+    }
+
+    u8 ToChannel(float c)
+    {
+        return static_cast<u8>(std::lround(std::min(std::max(c,0.0f),1.0f)*255.0f));
+    }
+
+    void FillRect(gui::SoftwareSurface const &surface,
+                  sint x, sint y, sint width, sint height,
+                  float r, float g, float b)
+    {
+        // Clip to the surface
+        sint const x0 = std::max<sint>(x,0);
+        sint const y0 = std::max<sint>(y,0);
+        sint const x1 = std::min<sint>(x+width,static_cast<sint>(surface.width));
+        sint const y1 = std::min<sint>(y+height,static_cast<sint>(surface.height));
+
+        u8 const pixel[4] = { ToChannel(r),ToChannel(g),ToChannel(b),255 };
+
+        for(sint py=y0; py < y1; py++) {
+            u8* row = surface.data+(size_t(py)*surface.stride);
+            for(sint px=x0; px < x1; px++) {
+                std::memcpy(row+(size_t(px)*4),pixel,4);
+            }
+        }
+    }
+
+    // * Rects are top left based and drawn in order
+    void RenderScene(GoldenScene const &scene,
+                     gui::SoftwareSurface const &surface)
+    {
+        FillRect(surface,0,0,
+                 static_cast<sint>(surface.width),
+                 static_cast<sint>(surface.height),
+                 0,0,0);
+
+        for(auto const &rect : scene.list_rects) {
+            FillRect(surface,rect.x,rect.y,rect.width,rect.height,
+                     rect.r,rect.g,rect.b);
+        }
+    }
+
+    // ============================================================= //
+
+    // Lives on the window's EventLoop and renders one
+    // scene per request from signal_frame
+    class GoldenRenderer : public ks::Object
+    {
+    public:
+        using base_type = ks::Object;
+
+        GoldenRenderer(ks::Object::Key const &key,
+                       shared_ptr<EventLoop> evl,
+                       gui::Window* win,
+                       std::vector<GoldenScene> const * list_scenes) :
+            ks::Object(key,evl),
+            m_win(win),
+            m_list_scenes(list_scenes),
+            m_scene(nullptr),
+            m_resizing(false)
+        {}
+
+        void Init(ks::Object::Key const &,
+                  shared_ptr<GoldenRenderer> const &)
+        {}
+
+        ~GoldenRenderer()
+        {}
+
+        void OnRenderScene(uint index)
+        {
+            m_scene = &((*m_list_scenes)[index]);
+
+            if(m_win->size.Get() != m_scene->size) {
+                // Render once the platform has confirmed the
+                // new size so the frame is allocated for it
+                m_resizing = true;
+                m_win->ApplyProperties(
+                            gui::Window::PropertyChanges().SetSize(
+                                m_scene->size));
+                return;
+            }
+
+            m_win->RequestFrame();
+        }
+
+        void OnPropertiesChanged(gui::Window::PropertyChanges changes)
+        {
+            if(m_resizing &&
+               changes.GetHas(gui::Window::PropertyChanges::SIZE) &&
+               changes.size == m_scene->size)
+            {
+                m_resizing = false;
+                m_win->RequestFrame();
+            }
+        }
+
+        void OnFrame()
+        {
+            // Also emitted once when the window is ready
+            if(!m_scene || m_resizing) {
+                return;
+            }
+
+            GoldenScene const * scene = m_scene;
+            m_scene = nullptr;
+
+            std::string path;
+            m_win->InvokeWithContext(
+                        [&](){
+                            auto platform_win = gui::ShmPlatformWindow::GetCurrent();
+                            if(platform_win) {
+                                RenderScene(*scene,platform_win->GetSurface());
+                                path = platform_win->GetPath();
+                            }
+                        });
+
+            m_win->SwapBuffers();
+
+            signal_presented.Emit(path);
+        }
+
+        // * The path of the shared framebuffer the scene
+        //   was presented to, or empty if it couldn't
+        //   be rendered
+        Signal<std::string> signal_presented;
+
+    private:
+        gui::Window* m_win;
+        std::vector<GoldenScene> const * m_list_scenes;
+        GoldenScene const * m_scene;
+        bool m_resizing;
+    };
+
+    // ============================================================= //
+
+    class GoldenTest : public ks::Object
+    {
+    public:
+        using base_type = ks::Object;
+
+        GoldenTest(ks::Object::Key const &key,
+                   shared_ptr<EventLoop> evl,
+                   std::vector<GoldenScene> const * list_scenes,
+                   std::string golden_dir,
+                   bool update) :
+            ks::Object(key,evl),
+            m_list_scenes(list_scenes),
+            m_golden_dir(std::move(golden_dir)),
+            m_update(update),
+            m_index(0),
+            m_frame_index(0),
+            m_failures(0)
+        {}
+
+        void Init(ks::Object::Key const &,
+                  shared_ptr<GoldenTest> const &)
+        {}
+
+        ~GoldenTest()
+        {}
+
+        void OnAppInit()
+        {
+            signal_render_scene.Emit(m_index);
+        }
+
+        void OnPresented(std::string path)
+        {
+            GoldenScene const &scene = (*m_list_scenes)[m_index];
+
+            gui::Image image;
+            if(captureFrame(path,image)) {
+                checkScene(scene.name,image);
+            }
+            else {
+                LOG.Warn() << "Golden: " << scene.name << ": capture failed";
+                m_failures++;
+            }
+
+            m_index++;
+            if(m_index < m_list_scenes->size()) {
+                signal_render_scene.Emit(m_index);
+                return;
+            }
+
+            LOG.Trace() << "Golden: " << m_list_scenes->size()-m_failures
+                        << "/" << m_list_scenes->size() << " passed";
+
+            signal_done.Emit();
+        }
+
+        uint GetFailures() const
+        {
+            return m_failures;
+        }
+
+        Signal<uint> signal_render_scene;
+        Signal<> signal_done;
+
+    private:
+        // * Reads the frame back from the shared framebuffer;
+        //   each scene must publish exactly one new frame
+        bool captureFrame(std::string const &path, gui::Image &image)
+        {
+            if(path.empty()) {
+                return false;
+            }
+
+            if(!m_reader) {
+                try {
+                    m_reader = make_unique<gui::ShmFrameReader>(path);
+                }
+                catch(gui::ShmFrameReaderError const &e) {
+                    LOG.Warn() << "Golden: " << e.what();
+                    return false;
+                }
+            }
+
+            gui::ShmFrameReader::Frame frame;
+            if(!m_reader->AcquireFrame(frame)) {
+                return false;
+            }
+
+            if(frame.index != m_frame_index+1) {
+                LOG.Warn() << "Golden: Expected frame " << m_frame_index+1
+                           << ", got " << frame.index;
+            }
+            m_frame_index = frame.index;
+
+            image = gui::Image::FromSurface(frame.surface);
+
+            // Nothing is rendered until the next scene is
+            // requested, so the frame can't be overwritten
+            return (m_reader->ValidateFrame(frame) && !image.data.empty());
+        }
+
+        void checkScene(std::string const &name, gui::Image const &image)
+        {
+            std::string const path = m_golden_dir+"/"+name+".pam";
+
+            if(m_update) {
+                if(!image.WritePam(path)) {
+                    LOG.Warn() << "Golden: Failed to write " << path;
+                    m_failures++;
+                }
+                return;
+            }
+
+            if(!gui::Image::ReadFile(path,m_golden)) {
+                LOG.Warn() << "Golden: " << name << ": missing " << path;
+                m_failures++;
+                return;
+            }
+
+            auto const result = gui::ImageDiff::Compare(m_golden,image,g_tolerance);
+
+            if(result.size_mismatch) {
+                LOG.Warn() << "Golden: " << name << ": size mismatch";
+                m_failures++;
+                return;
+            }
+
+            if(result.differing_pixels > 0) {
+                LOG.Warn() << "Golden: " << name << ": "
+                           << result.differing_pixels << " pixels differ"
+                           << " (max difference "
+                           << uint(result.max_difference) << ")";
+
+                image.WritePam(m_golden_dir+"/"+name+".actual.pam");
+                gui::ImageDiff::MakeDiffImage(m_golden,image,g_tolerance).WritePpm(
+                            m_golden_dir+"/"+name+".diff.ppm");
+
+                m_failures++;
+            }
+        }
+
+        std::vector<GoldenScene> const * m_list_scenes;
+        std::string const m_golden_dir;
+        bool const m_update;
+        uint m_index;
+        u64 m_frame_index;
+        uint m_failures;
+        unique_ptr<gui::ShmFrameReader> m_reader;
+        gui::Image m_golden;
+    };
+}
+
+int main(int argc, char* argv[])
+{
+    std::string golden_dir = "golden";
+    bool update = false;
+
+    for(int i=1; i < argc; i++) {
+        std::string const arg(argv[i]);
+        if(arg == "--update") {
+            update = true;
+        }
+        else {
+            golden_dir = arg;
+        }
+    }
+
+    auto const list_scenes = CreateScenes();
+
+    // Create application
+    auto app = MakeObject<gui::Application>();
+
+    // Create window at the size of the first scene
+    gui::Window::Attributes win_attribs;
+    gui::Window::Properties win_props;
+    win_props.width = list_scenes[0].size.first;
+    win_props.height = list_scenes[0].size.second;
+    win_props.swap_interval = 0;
+    win_props.title = "Golden";
+
+    auto win_render_evl = make_shared<EventLoop>();
+    auto win_render_thread = EventLoop::LaunchInThread(win_render_evl);
+    auto win = app->CreateWindow(win_render_evl,win_attribs,win_props);
+
+    auto renderer =
+            MakeObject<GoldenRenderer>(
+                win_render_evl,
+                win.get(),
+                &list_scenes);
+
+    auto test =
+            MakeObject<GoldenTest>(
+                app->GetEventLoop(),
+                &list_scenes,
+                golden_dir,
+                update);
+
+    // Setup connections
+
+    // Application ---> GoldenTest
+    app->signal_init.Connect(
+                test,
+                &GoldenTest::OnAppInit);
+
+    // GoldenTest ---> GoldenRenderer
+    test->signal_render_scene.Connect(
+                renderer,
+                &GoldenRenderer::OnRenderScene);
+
+    // Window ---> GoldenRenderer
+    // (both are emitted on the window's EventLoop)
+    win->signal_frame.Connect(
+                renderer,
+                &GoldenRenderer::OnFrame,
+                ks::ConnectionType::Direct);
+
+    win->signal_properties_changed.Connect(
+                renderer,
+                &GoldenRenderer::OnPropertiesChanged,
+                ks::ConnectionType::Direct);
+
+    // GoldenRenderer ---> GoldenTest
+    renderer->signal_presented.Connect(
+                test,
+                &GoldenTest::OnPresented);
+
+    // GoldenTest ---> Application
+    test->signal_done.Connect(
+                app,
+                &gui::Application::Quit);
+
+    // Run!
+    app->Run();
+
+    // Clean up threads
+    EventLoop::RemoveFromThread(win_render_evl,win_render_thread,true);
+
+    return (test->GetFailures() == 0) ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include <cmath>
+#include <vector>
+#include <ks/gui/KsGuiInputTransform.hpp>
+
+using namespace ks;
+
+namespace {
+
+    uint g_failures = 0;
+
+    void Check(bool passed, std::string const &what)
+    {
+        if(!passed) {
+            LOG.Warn() << "FAILED: " << what;
+            g_failures++;
+        }
+    }
+
+    bool Near(float a, float b)
+    {
+        return (std::fabs(a-b) < 1E-3f);
+    }
+
+    // * Maps a native point through the transform and
+    //   compares it against the expected logical point
+    void CheckPoint(gui::InputTransform const &xf,
+                    float x, float y,
+                    float ex, float ey,
+                    std::string const &what)
+    {
+        xf.Apply(x,y);
+        Check(Near(x,ex) && Near(y,ey),
+              what+": got ("+std::to_string(x)+","+std::to_string(y)+
+              "), expected ("+std::to_string(ex)+","+std::to_string(ey)+")");
+    }
+
+    void TestRotations()
+    {
+        // 1000x500 native screen at twice the reference
+        // density, window at (100,50) in rotated pixels
+        gui::Screen::Size const size_px(1000,500);
+        float const dpi = gui::InputTransform::ReferenceDpi*2.0f;
+        gui::Window::Position const win_pos(100,50);
+
+        auto xf0 = gui::InputTransform::Create(
+                    gui::Screen::Rotation::CW_0,size_px,dpi,dpi,win_pos);
+        CheckPoint(xf0,100,50,0,0,"CW_0 window origin");
+        CheckPoint(xf0,300,250,100,100,"CW_0");
+
+        // rx = y, ry = w-x
+        auto xf90 = gui::InputTransform::Create(
+                    gui::Screen::Rotation::CW_90,size_px,dpi,dpi,win_pos);
+        CheckPoint(xf90,950,100,0,0,"CW_90 window origin");
+        CheckPoint(xf90,750,300,100,100,"CW_90");
+
+        // rx = w-x, ry = h-y
+        auto xf180 = gui::InputTransform::Create(
+                    gui::Screen::Rotation::CW_180,size_px,dpi,dpi,win_pos);
+        CheckPoint(xf180,900,450,0,0,"CW_180 window origin");
+        CheckPoint(xf180,700,250,100,100,"CW_180");
+
+        // rx = h-y, ry = x
+        auto xf270 = gui::InputTransform::Create(
+                    gui::Screen::Rotation::CW_270,size_px,dpi,dpi,win_pos);
+        CheckPoint(xf270,50,400,0,0,"CW_270 window origin");
+        CheckPoint(xf270,250,200,100,100,"CW_270");
+
+        // Platforms that don't report a density are unscaled
+        auto xf_nodpi = gui::InputTransform::Create(
+                    gui::Screen::Rotation::CW_0,size_px,0.0f,0.0f,win_pos);
+        CheckPoint(xf_nodpi,300,250,200,200,"no density");
+    }
+
+    void TestBatch()
+    {
+        auto xf = gui::InputTransform::Create(
+                    gui::Screen::Rotation::CW_90,
+                    gui::Screen::Size(1920,1080),
+                    144.0f,
+                    120.0f,
+                    gui::Window::Position(-30,75));
+
+        // Odd counts exercise both the SIMD loop and the
+        // scalar remainder
+        for(std::size_t count : {0,1,3,4,5,17}) {
+            std::vector<float> list_x(count);
+            std::vector<float> list_y(count);
+            for(std::size_t i=0; i < count; i++) {
+                list_x[i] = 13.5f*i;
+                list_y[i] = 1000.0f-7.25f*i;
+            }
+
+            std::vector<float> list_ex(list_x);
+            std::vector<float> list_ey(list_y);
+            for(std::size_t i=0; i < count; i++) {
+                xf.Apply(list_ex[i],list_ey[i]);
+            }
+
+            xf.Apply(list_x.data(),list_y.data(),count);
+
+            for(std::size_t i=0; i < count; i++) {
+                Check(Near(list_x[i],list_ex[i]) && Near(list_y[i],list_ey[i]),
+                      "batch of "+std::to_string(count)+
+                      " differs at "+std::to_string(i));
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    TestRotations();
+    TestBatch();
+
+    if(g_failures > 0) {
+        LOG.Warn() << g_failures << " InputTransform checks failed";
+        return 1;
+    }
+
+    LOG.Trace() << "All InputTransform checks passed";
+    return 0;
+}
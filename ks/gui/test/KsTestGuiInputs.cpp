@@ -52,9 +52,9 @@ namespace {
                     << "mods: " << static_cast<uint>(event.mods);
     }
 
-    void PrintTextInput(std::string s)
+    void PrintTextInput(gui::TextInputEvent event)
     {
-        LOG.Trace() << "TextInput: " << s;
+        LOG.Trace() << "TextInput: " << event.ToString();
     }
 
     void PrintMouseOutput(gui::MouseEvent event)
@@ -120,7 +120,7 @@ int main(int argc, char* argv[])
     app->signal_keyboard_input->Connect(
                 &PrintKeyPress);
 
-    app->signal_utf8_input->Connect(
+    app->signal_text_input->Connect(
                 &PrintTextInput);
 
     app->signal_mouse_input->Connect(
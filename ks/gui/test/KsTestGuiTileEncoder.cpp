@@ -0,0 +1,219 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include <cstring>
+#include <algorithm>
+#include <vector>
+#include <ks/gui/KsGuiTileEncoder.hpp>
+
+using namespace ks;
+
+namespace {
+
+    uint g_failures = 0;
+
+    void Check(bool passed, std::string const &what)
+    {
+        if(!passed) {
+            LOG.Warn() << "FAILED: " << what;
+            g_failures++;
+        }
+    }
+
+    template<typename T>
+    T Read(std::vector<u8> const &buffer, std::size_t offset)
+    {
+        T value;
+        std::memcpy(&value,&buffer[offset],sizeof(T));
+        return value;
+    }
+
+    struct Decoded
+    {
+        uint tiles;
+        uint list_counts[3]; // by Encoding
+    };
+
+    // * Applies the tiles in @buffer to @image the way a
+    //   client would
+    Decoded Decode(std::vector<u8> const &buffer,
+                   std::vector<u32> &image,
+                   uint width,
+                   uint height)
+    {
+        using Encoding = gui::TileEncoder::Encoding;
+        uint const tile_size = gui::TileEncoder::TileSize;
+
+        Decoded decoded{0,{0,0,0}};
+        std::size_t offset = 0;
+
+        while(offset < buffer.size())
+        {
+            uint const x0 = Read<u16>(buffer,offset)*tile_size;
+            uint const y0 = Read<u16>(buffer,offset+2)*tile_size;
+            Encoding const encoding = static_cast<Encoding>(buffer[offset+4]);
+            u32 const size = Read<u32>(buffer,offset+5);
+            offset += 9;
+
+            uint const w = std::min(tile_size,width-x0);
+            uint const h = std::min(tile_size,height-y0);
+
+            if(encoding == Encoding::Solid) {
+                u32 const pixel = Read<u32>(buffer,offset);
+                for(uint y=0; y < h; y++) {
+                    for(uint x=0; x < w; x++) {
+                        image[(y0+y)*width+x0+x] = pixel;
+                    }
+                }
+            }
+            else if(encoding == Encoding::Raw) {
+                for(uint y=0; y < h; y++) {
+                    std::memcpy(&image[(y0+y)*width+x0],
+                                &buffer[offset+(y*w*4)],
+                                w*4);
+                }
+            }
+            else {
+                uint i=0;
+                for(u32 run=0; run < size; run += 6) {
+                    u32 const pixel = Read<u32>(buffer,offset+run);
+                    u16 const count = Read<u16>(buffer,offset+run+4);
+                    for(uint k=0; k < count && i < w*h; k++,i++) {
+                        image[(y0+(i/w))*width+x0+(i%w)] = pixel;
+                    }
+                }
+                Check(i == w*h,"Rle tile doesn't cover its pixels");
+            }
+
+            offset += size;
+            decoded.tiles++;
+            decoded.list_counts[static_cast<uint>(encoding)]++;
+        }
+
+        return decoded;
+    }
+
+    void TestRoundTrip()
+    {
+        // Not a multiple of the tile size, so edge
+        // tiles are partial
+        uint const width = 300;
+        uint const height = 170;
+
+        // Rows 0-63: solid, 64-127: horizontal runs,
+        // 128-169: noise
+        std::vector<u32> list_pixels(width*height);
+        u32 seed = 12345;
+        for(uint y=0; y < height; y++) {
+            for(uint x=0; x < width; x++) {
+                u32 pixel;
+                if(y < 64) {
+                    pixel = 0xFF00FF00;
+                }
+                else if(y < 128) {
+                    pixel = 0xFF000000 | (x/16);
+                }
+                else {
+                    seed = seed*1664525+1013904223;
+                    pixel = seed;
+                }
+                list_pixels[y*width+x] = pixel;
+            }
+        }
+
+        gui::SoftwareSurface surface;
+        surface.data = reinterpret_cast<u8*>(list_pixels.data());
+        surface.width = width;
+        surface.height = height;
+        surface.stride = width*4;
+
+        uint const tile_count = 5*3;
+        std::vector<u32> list_decoded(width*height,0xDEADBEEF);
+        std::vector<u8> buffer;
+
+        gui::TileEncoder encoder;
+        uint tiles = encoder.Encode(surface,buffer);
+        Decoded decoded = Decode(buffer,list_decoded,width,height);
+
+        Check(tiles == tile_count && decoded.tiles == tile_count,
+              "first frame should send every tile");
+        Check(decoded.list_counts[0] == 5 &&
+              decoded.list_counts[1] == 5 &&
+              decoded.list_counts[2] == 5,
+              "expected one row each of Solid, Rle and Raw tiles");
+        Check(list_decoded == list_pixels,"first frame round trip");
+
+        buffer.clear();
+        Check(encoder.Encode(surface,buffer) == 0 && buffer.empty(),
+              "unchanged frame should send nothing");
+
+        list_pixels[120*width+250] ^= 1;
+        buffer.clear();
+        tiles = encoder.Encode(surface,buffer);
+        Decode(buffer,list_decoded,width,height);
+        Check(tiles == 1,"one changed pixel should send one tile");
+        Check(list_decoded == list_pixels,"changed pixel round trip");
+
+        encoder.Reset();
+        buffer.clear();
+        Check(encoder.Encode(surface,buffer) == tile_count,
+              "Reset should send every tile");
+    }
+
+    void TestHash()
+    {
+        // Row sizes that aren't a multiple of 16 bytes and
+        // a stride with padding exercise the tail handling
+        uint const stride = 71*4;
+        std::vector<u8> list_data(stride*40);
+        for(std::size_t i=0; i < list_data.size(); i++) {
+            list_data[i] = static_cast<u8>((i*131)^(i>>7));
+        }
+
+        for(uint width : {1,3,4,5,16,17,64,70}) {
+            for(uint height : {1,7,40}) {
+                u64 const hash =
+                        gui::TileEncoder::HashTile(
+                            list_data.data(),stride,width,height);
+                u64 const hash_scalar =
+                        gui::TileEncoder::HashTileScalar(
+                            list_data.data(),stride,width,height);
+
+                Check(hash == hash_scalar,
+                      "HashTile doesn't match the scalar hash for "+
+                      std::to_string(width)+"x"+std::to_string(height));
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    TestRoundTrip();
+    TestHash();
+
+    if(g_failures > 0) {
+        LOG.Warn() << g_failures << " TileEncoder checks failed";
+        return 1;
+    }
+
+    LOG.Trace() << "All TileEncoder checks passed";
+    return 0;
+}
@@ -29,6 +29,57 @@ using namespace ks;
 
 namespace
 {
+    // Renders a Window from its own EventLoop. Each frame
+    // requests the next one through the Window, which reuses
+    // a single task, so steady state rendering doesn't
+    // allocate.
+    class Renderer : public ks::Object
+    {
+    public:
+        using base_type = ks::Object;
+
+        Renderer(ks::Object::Key const &key,
+                 shared_ptr<EventLoop> evl,
+                 gui::Window* win) :
+            ks::Object(key,evl),
+            m_running(false),
+            m_win(win),
+            m_gl_clear([](){ gl::Clear(gl::ColorBufferBit); })
+        {}
+
+        void Init(ks::Object::Key const &,
+                  shared_ptr<Renderer> const &)
+        {}
+
+        ~Renderer()
+        {}
+
+        // * Thread safe
+        void SetRunning(bool running)
+        {
+            m_running = running;
+            if(running) {
+                m_win->RequestFrame();
+            }
+        }
+
+        void OnFrame()
+        {
+            if(!m_running) {
+                return;
+            }
+
+            m_win->InvokeWithContext(m_gl_clear);
+            m_win->SwapBuffers();
+            m_win->RequestFrame();
+        }
+
+    private:
+        std::atomic<bool> m_running;
+        gui::Window* m_win;
+        std::function<void()> const m_gl_clear;
+    };
+
     class Scene : public ks::Object
     {
     public:
@@ -36,26 +87,18 @@ namespace
 
         Scene(ks::Object::Key const &key,
               shared_ptr<EventLoop> evl,
+              gui::Application* app,
               gui::Window* win0,
-              gui::Window* win1) :
+              gui::Window* win1,
+              Renderer* renderer0,
+              Renderer* renderer1) :
             ks::Object(key,evl),
+            m_app(app),
             m_win0(win0),
-            m_win1(win1)
-        {
-            auto gl_clear = [](){ gl::Clear(gl::ColorBufferBit); };
-
-            m_render_task_fn0 =
-                    [win0,gl_clear](){
-                        win0->InvokeWithContext(gl_clear);
-                        win0->SwapBuffers();
-                    };
-
-            m_render_task_fn1 =
-                    [win1,gl_clear](){
-                        win1->InvokeWithContext(gl_clear);
-                        win1->SwapBuffers();
-                    };
-        }
+            m_win1(win1),
+            m_renderer0(renderer0),
+            m_renderer1(renderer1)
+        {}
 
         void Init(ks::Object::Key const &,
                   shared_ptr<Scene> const &)
@@ -115,41 +158,45 @@ namespace
 
             m_win1->GetEventLoop()->PostTask(set_blue_task);
             set_blue_task->Wait();
+
+            // Start rendering
+            m_renderer0->SetRunning(true);
+            m_renderer1->SetRunning(true);
         }
 
         void OnAppPause()
         {
             m_running = false;
+            m_renderer0->SetRunning(false);
+            m_renderer1->SetRunning(false);
         }
 
         void OnAppResume()
         {
             m_running = true;
+            m_renderer0->SetRunning(true);
+            m_renderer1->SetRunning(true);
             signal_app_process_events.Emit();
         }
 
         void OnAppQuit()
         {
             m_running = false;
+            m_renderer0->SetRunning(false);
+            m_renderer1->SetRunning(false);
         }
 
         void OnAppProcEvents(bool)
         {
             if(m_running)
             {
-                auto render_task0 = make_shared<ks::Task>(m_render_task_fn0);
-                m_win0->GetEventLoop()->PostTask(render_task0);
-
-                auto render_task1 = make_shared<ks::Task>(m_render_task_fn1);
-                m_win1->GetEventLoop()->PostTask(render_task1);
-
-                render_task0->Wait();
-                render_task1->Wait();
-
-                // We're assuming vsync is true and will introduce
-                // a delay so we schedule the next ProcessEvents task
-                // immediately
-                signal_app_process_events.Emit();
+                // The windows render themselves (see Renderer),
+                // so sleep until there are events instead of
+                // spinning; processing them emits
+                // signal_processed_events again. Quitting or
+                // pausing is reported through events, so the
+                // loop stops with m_running.
+                m_app->WaitEvents(Milliseconds(-1));
             }
         }
 
@@ -159,11 +206,11 @@ namespace
     private:
         std::atomic<bool> m_running;
 
+        gui::Application* m_app;
         gui::Window* m_win0;
         gui::Window* m_win1;
-
-        std::function<void()> m_render_task_fn0;
-        std::function<void()> m_render_task_fn1;
+        Renderer* m_renderer0;
+        Renderer* m_renderer1;
 
         unique_ptr<gl::StateSet> m_gl_state_set0;
         unique_ptr<gl::StateSet> m_gl_state_set1;
@@ -197,15 +244,35 @@ int main(int argc, char* argv[])
     auto win1_render_thread = EventLoop::LaunchInThread(win1_render_evl);
     auto win1 = app->CreateWindow(win1_render_evl,win_attribs,win_props);
 
+    // Create a renderer for each window on its EventLoop
+    auto renderer0 = MakeObject<Renderer>(win0_render_evl,win0.get());
+    auto renderer1 = MakeObject<Renderer>(win1_render_evl,win1.get());
+
     // Create scene
     auto scene =
             MakeObject<Scene>(
                 app->GetEventLoop(),
+                app.get(),
                 win0.get(),
-                win1.get());
+                win1.get(),
+                renderer0.get(),
+                renderer1.get());
 
     // Setup connections
 
+    // Window ---> Renderer
+    // (signal_frame is emitted on the window's EventLoop,
+    // which the renderer lives on)
+    win0->signal_frame.Connect(
+                renderer0,
+                &Renderer::OnFrame,
+                ks::ConnectionType::Direct);
+
+    win1->signal_frame.Connect(
+                renderer1,
+                &Renderer::OnFrame,
+                ks::ConnectionType::Direct);
+
     // Application ---> Scene
     app->signal_init.Connect(
                 scene,
@@ -7,13 +7,50 @@ PATH_KS_GUI = $${PWD}/ks/gui
 HEADERS += \
     $${PATH_KS_GUI}/KsGuiConfig.hpp \
     $${PATH_KS_GUI}/KsGuiPlatform.hpp \
+    $${PATH_KS_GUI}/KsGuiPlatformDispatch.hpp \
     $${PATH_KS_GUI}/KsGuiApplication.hpp \
     $${PATH_KS_GUI}/KsGuiScreen.hpp \
     $${PATH_KS_GUI}/KsGuiWindow.hpp \
-    $${PATH_KS_GUI}/KsGuiInput.hpp
+    $${PATH_KS_GUI}/KsGuiInput.hpp \
+    $${PATH_KS_GUI}/KsGuiInputTransform.hpp \
+    $${PATH_KS_GUI}/KsGuiGesture.hpp \
+    $${PATH_KS_GUI}/KsGuiInputPredictor.hpp \
+    $${PATH_KS_GUI}/KsGuiInputState.hpp \
+    $${PATH_KS_GUI}/KsGuiEventWaiter.hpp \
+    $${PATH_KS_GUI}/KsGuiFramePacer.hpp \
+    $${PATH_KS_GUI}/KsGuiTrace.hpp \
+    $${PATH_KS_GUI}/KsGuiMetrics.hpp \
+    $${PATH_KS_GUI}/KsGuiWindowChannel.hpp \
+    $${PATH_KS_GUI}/KsGuiPresentGroup.hpp \
+    $${PATH_KS_GUI}/KsGuiShmPlatform.hpp \
+    $${PATH_KS_GUI}/KsGuiTileEncoder.hpp \
+    $${PATH_KS_GUI}/KsGuiRemotePlatform.hpp \
+    $${PATH_KS_GUI}/KsGuiImage.hpp \
+    $${PATH_KS_GUI}/KsGuiImageDiff.hpp \
+    $${PATH_KS_GUI}/KsGuiContextConfigCache.hpp \
+    $${PATH_KS_GUI}/KsGuiProgramCache.hpp \
+    $${PATH_KS_GUI}/KsGuiFrameArena.hpp
 
 SOURCES += \
     $${PATH_KS_GUI}/KsGuiPlatform.cpp \
     $${PATH_KS_GUI}/KsGuiApplication.cpp \
     $${PATH_KS_GUI}/KsGuiScreen.cpp \
-    $${PATH_KS_GUI}/KsGuiWindow.cpp
+    $${PATH_KS_GUI}/KsGuiWindow.cpp \
+    $${PATH_KS_GUI}/KsGuiInput.cpp \
+    $${PATH_KS_GUI}/KsGuiInputTransform.cpp \
+    $${PATH_KS_GUI}/KsGuiGesture.cpp \
+    $${PATH_KS_GUI}/KsGuiInputPredictor.cpp \
+    $${PATH_KS_GUI}/KsGuiInputState.cpp \
+    $${PATH_KS_GUI}/KsGuiEventWaiter.cpp \
+    $${PATH_KS_GUI}/KsGuiFramePacer.cpp \
+    $${PATH_KS_GUI}/KsGuiTrace.cpp \
+    $${PATH_KS_GUI}/KsGuiMetrics.cpp \
+    $${PATH_KS_GUI}/KsGuiPresentGroup.cpp \
+    $${PATH_KS_GUI}/KsGuiShmPlatform.cpp \
+    $${PATH_KS_GUI}/KsGuiTileEncoder.cpp \
+    $${PATH_KS_GUI}/KsGuiRemotePlatform.cpp \
+    $${PATH_KS_GUI}/KsGuiImage.cpp \
+    $${PATH_KS_GUI}/KsGuiImageDiff.cpp \
+    $${PATH_KS_GUI}/KsGuiContextConfigCache.cpp \
+    $${PATH_KS_GUI}/KsGuiProgramCache.cpp \
+    $${PATH_KS_GUI}/KsGuiFrameArena.cpp